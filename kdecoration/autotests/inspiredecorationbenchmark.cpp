@@ -0,0 +1,148 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+//* headless paint benchmark
+/**
+decorations are created through a mock bridge, and painted into an image
+for each combination of border size, button size, title alignment, active state and device pixel ratio.
+Reports the time, in nanoseconds, per full decoration paint, per paint restricted to the title bar rect,
+as requested by kwin on caption or active state changes, and per button paint.
+
+usage: inspiredecorationbenchmark [iterations]
+*/
+
+#include "inspiredecoration.h"
+#include "inspiremockbridge.h"
+
+#include <KDecoration2/DecorationButton>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+#include <QStandardPaths>
+#include <QTextStream>
+
+#include <cstdio>
+
+namespace
+{
+
+    //* setting value, with its name
+    struct Choice
+    {
+        int value;
+        const char* name;
+    };
+
+    //* average time per call, in nanoseconds
+    template<typename Function>
+    qint64 nsPerCall( int iterations, Function function )
+    {
+        // first call fills caches, and is not timed
+        function();
+
+        QElapsedTimer timer;
+        timer.start();
+        for( int i = 0; i < iterations; ++i ) function();
+        return timer.nsecsElapsed()/iterations;
+    }
+
+}
+
+int main( int argc, char** argv )
+{
+
+    // paint without display server, and without reading user configuration
+    if( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) ) qputenv( "QT_QPA_PLATFORM", "offscreen" );
+    QStandardPaths::setTestModeEnabled( true );
+
+    QGuiApplication application( argc, argv );
+
+    const int iterations = argc > 1 ? qMax( 1, QString::fromLocal8Bit( argv[1] ).toInt() ) : 200;
+
+    using Inspire::InternalSettings;
+    const QVector<Choice> borderSizes = {
+        { InternalSettings::BorderNone, "none" },
+        { InternalSettings::BorderNormal, "normal" },
+        { InternalSettings::BorderHuge, "huge" } };
+
+    const QVector<Choice> buttonSizes = {
+        { InternalSettings::ButtonSmall, "small" },
+        { InternalSettings::ButtonDefault, "default" },
+        { InternalSettings::ButtonLarge, "large" } };
+
+    const QVector<Choice> alignments = {
+        { InternalSettings::AlignLeft, "left" },
+        { InternalSettings::AlignCenter, "center" },
+        { InternalSettings::AlignCenterFullWidth, "full" },
+        { InternalSettings::AlignRight, "right" } };
+
+    const QVector<qreal> devicePixelRatios = { 1.0, 2.0 };
+
+    QTextStream out( stdout );
+    out << QStringLiteral( "%1 %2 %3 %4 %5 %6 %7 %8\n" )
+        .arg( "border", -8 ).arg( "button", -8 ).arg( "align", -8 ).arg( "active", -8 ).arg( "dpr", -5 )
+        .arg( "paint(ns)", 12 ).arg( "titlerect(ns)", 14 ).arg( "button(ns)", 12 );
+
+    Inspire::MockBridge bridge;
+    for( const Choice& borderSize : borderSizes )
+    for( const Choice& buttonSize : buttonSizes )
+    for( const Choice& alignment : alignments )
+    for( const bool active : { true, false } )
+    for( const qreal devicePixelRatio : devicePixelRatios )
+    {
+
+        bridge.window.active = active;
+        QScopedPointer<Inspire::Decoration> decoration( bridge.createDecoration() );
+
+        InternalSettings internalSettings;
+        internalSettings.setButtonSize( buttonSize.value );
+        internalSettings.setTitleAlignment( alignment.value );
+        const auto settings = Inspire::EffectiveSettings::fromInternalSettings( internalSettings ).overridden( false, borderSize.value );
+        decoration->applySettings( Inspire::EffectiveSettingsPtr( new Inspire::EffectiveSettings( settings ) ), Inspire::AllChanges );
+
+        // button geometry is updated from the event loop
+        QCoreApplication::processEvents();
+
+        const QRect rect( decoration->rect() );
+        QImage image( rect.size()*devicePixelRatio, QImage::Format_ARGB32_Premultiplied );
+        image.setDevicePixelRatio( devicePixelRatio );
+        QPainter painter( &image );
+
+        const qint64 paintTime = nsPerCall( iterations, [&]() { decoration->paint( &painter, rect ); } );
+
+        // paint() restricted to the title bar rect, as repainted by kwin on caption or active state changes.
+        // This includes the frame checks done by paint(), on top of the title bar itself
+        const QRect titleBar( decoration->titleBar() );
+        const qint64 titleRectTime = nsPerCall( iterations, [&]() { decoration->paint( &painter, titleBar ); } );
+
+        // buttons, averaged over all visible ones
+        qint64 buttonTime = 0;
+        int buttonCount = 0;
+        const auto buttons = decoration->findChildren<KDecoration2::DecorationButton*>();
+        for( KDecoration2::DecorationButton* button : buttons )
+        {
+            if( !button->isVisible() ) continue;
+            const QRect geometry( button->geometry().toAlignedRect() );
+            buttonTime += nsPerCall( iterations, [&]() { button->paint( &painter, geometry ); } );
+            ++buttonCount;
+        }
+
+        if( buttonCount > 0 ) buttonTime /= buttonCount;
+
+        out << QStringLiteral( "%1 %2 %3 %4 %5 %6 %7 %8\n" )
+            .arg( borderSize.name, -8 ).arg( buttonSize.name, -8 ).arg( alignment.name, -8 )
+            .arg( active ? "yes" : "no", -8 ).arg( devicePixelRatio, -5, 'f', 1 )
+            .arg( paintTime, 12 ).arg( titleRectTime, 14 ).arg( buttonTime, 12 );
+        out.flush();
+
+    }
+
+    return 0;
+
+}
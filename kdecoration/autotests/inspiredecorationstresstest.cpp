@@ -0,0 +1,181 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "inspiredecoration.h"
+#include "inspiremockbridge.h"
+#include "inspireprofiler.h"
+
+#include <KDecoration2/DecorationButton>
+#include <KDecoration2/DecorationShadow>
+
+#include <QImage>
+#include <QPainter>
+#include <QPointer>
+#include <QStandardPaths>
+#include <QTest>
+#include <QWeakPointer>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+//* creates, paints and destroys decorations repeatedly, and checks that nothing is left behind
+class DecorationStressTest: public QObject
+{
+
+    Q_OBJECT
+
+    public:
+
+    //* paint without display server, and without reading user configuration
+    static void initMain();
+
+    private Q_SLOTS:
+
+    void createDestroy();
+
+    private:
+
+    //* create, paint and destroy given number of decorations, in batches that are destroyed together
+    /**
+    time spent in each decoration init() is appended to initTimes, in nanoseconds,
+    and resident memory after each batch is appended to memory, in kilobytes
+    */
+    void runCycles( Inspire::MockBridge&, int, QVector<qint64>& initTimes, QVector<qint64>& memory );
+
+    //* given percentile of sorted values
+    static qint64 percentile( const QVector<qint64>&, int );
+
+    enum
+    {
+        //* decorations alive at the same time
+        BatchSize = 50,
+
+        //* cycles run before measuring baseline memory, to fill caches
+        WarmUpCycles = 500,
+
+        //* measured cycles
+        Cycles = 5000,
+
+        //* allowed resident memory growth, in kilobytes.
+        /** a leak of more than about 1 kilobyte per cycle exceeds it */
+        MemoryTolerance = 5*1024,
+
+        //* percentage of batches after which resident memory may grow, compared to the previous one.
+        /** allocator noise goes both ways, while a leak makes memory grow after almost every batch */
+        MaxGrowingBatches = 75
+    };
+
+};
+
+//________________________________________________________________
+void DecorationStressTest::initMain()
+{
+    if( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) ) qputenv( "QT_QPA_PLATFORM", "offscreen" );
+    QStandardPaths::setTestModeEnabled( true );
+}
+
+//________________________________________________________________
+void DecorationStressTest::runCycles( Inspire::MockBridge& bridge, int count, QVector<qint64>& initTimes, QVector<qint64>& memory )
+{
+
+    for( int first = 0; first < count; first += BatchSize )
+    {
+
+        std::vector<std::unique_ptr<Inspire::Decoration>> decorations;
+        QVector<QWeakPointer<KDecoration2::DecorationShadow>> shadows;
+        QVector<QPointer<KDecoration2::DecorationButton>> buttons;
+
+        for( int index = first; index < qMin( count, first + BatchSize ); ++index )
+        {
+
+            // vary window state, so that all shadow variants and button states are used
+            bridge.window.caption = QStringLiteral( "Window %1" ).arg( index );
+            bridge.window.active = ( index%2 == 0 );
+            bridge.window.maximized = ( index%7 == 0 );
+            bridge.window.adjacentScreenEdges = Qt::Edges( QFlag( index%16 ) );
+
+            std::unique_ptr<Inspire::Decoration> decoration( bridge.createDecoration() );
+            initTimes.append( bridge.initTime );
+
+            QImage image( decoration->size(), QImage::Format_ARGB32_Premultiplied );
+            {
+                QPainter painter( &image );
+                decoration->paint( &painter, decoration->rect() );
+            }
+
+            shadows.append( decoration->shadow().toWeakRef() );
+            for( KDecoration2::DecorationButton* button : decoration->findChildren<KDecoration2::DecorationButton*>() )
+            { buttons.append( button ); }
+
+            decorations.push_back( std::move( decoration ) );
+
+        }
+
+        // shadows are shared between decorations, with at most one per active state and screen edges
+        QVERIFY( Inspire::Decoration::shadowCacheSize() > 0 );
+        QVERIFY( Inspire::Decoration::shadowCacheSize() <= 32 );
+
+        // destroying the last decoration releases all shadows and buttons
+        decorations.clear();
+        QCoreApplication::sendPostedEvents( nullptr, QEvent::DeferredDelete );
+
+        QCOMPARE( Inspire::Decoration::shadowCacheSize(), 0 );
+        for( const auto& shadow : shadows ) QVERIFY( shadow.isNull() );
+        for( const auto& button : buttons ) QVERIFY( button.isNull() );
+
+        memory.append( Inspire::Profiler::residentMemory() );
+
+    }
+
+}
+
+//________________________________________________________________
+qint64 DecorationStressTest::percentile( const QVector<qint64>& values, int percent )
+{ return values.isEmpty() ? 0 : values.at( ( values.size() - 1 )*percent/100 ); }
+
+//________________________________________________________________
+void DecorationStressTest::createDestroy()
+{
+
+    Inspire::MockBridge bridge;
+
+    QVector<qint64> initTimes;
+    QVector<qint64> memory;
+    runCycles( bridge, WarmUpCycles, initTimes, memory );
+    if( QTest::currentTestFailed() ) return;
+
+    const qint64 baseline = Inspire::Profiler::residentMemory();
+    if( baseline < 0 ) QSKIP( "resident memory is unavailable on this platform" );
+
+    // measured cycles only
+    initTimes.clear();
+    memory = { baseline };
+    runCycles( bridge, Cycles, initTimes, memory );
+    if( QTest::currentTestFailed() ) return;
+
+    std::sort( initTimes.begin(), initTimes.end() );
+    qInfo( "init() over %d cycles: p50 %lld ns, p90 %lld ns, p99 %lld ns",
+        int( initTimes.size() ), percentile( initTimes, 50 ), percentile( initTimes, 90 ), percentile( initTimes, 99 ) );
+
+    // resident memory must not keep growing from batch to batch
+    int growingBatches = 0;
+    for( int index = 1; index < memory.size(); ++index )
+    { if( memory.at( index ) > memory.at( index - 1 ) ) ++growingBatches; }
+
+    const int batches = memory.size() - 1;
+    const qint64 growth = memory.last() - baseline;
+    qInfo( "resident memory: baseline %lld kB, final %lld kB, peak %lld kB, grew after %d of %d batches",
+        baseline, memory.last(), *std::max_element( memory.begin(), memory.end() ), growingBatches, batches );
+
+    QVERIFY2( growingBatches*100 <= batches*MaxGrowingBatches, qPrintable( QStringLiteral( "resident memory grew after %1 of %2 batches" ).arg( growingBatches ).arg( batches ) ) );
+    QVERIFY2( growth < MemoryTolerance, qPrintable( QStringLiteral( "resident memory grew by %1 kB over %2 cycles" ).arg( growth ).arg( int( Cycles ) ) ) );
+
+}
+
+QTEST_MAIN( DecorationStressTest )
+
+#include "inspiredecorationstresstest.moc"
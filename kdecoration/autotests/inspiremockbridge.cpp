@@ -0,0 +1,142 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "inspiremockbridge.h"
+#include "inspiredecoration.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QIcon>
+#include <QPainter>
+#include <QPixmap>
+#include <QThreadPool>
+#include <QVariantMap>
+
+namespace Inspire
+{
+
+    using KDecoration2::ColorGroup;
+    using KDecoration2::ColorRole;
+    using KDecoration2::DecorationButtonType;
+
+    //________________________________________________________________
+    MockClient::MockClient( KDecoration2::DecoratedClient* client, KDecoration2::Decoration* decoration, const MockWindow& window ):
+        KDecoration2::DecoratedClientPrivate( client, decoration ),
+        m_window( window )
+    {}
+
+    //________________________________________________________________
+    QIcon MockClient::icon() const
+    {
+        // no icon theme is available headless, so that application icon is generated
+        static const QIcon icon( []()
+        {
+            QPixmap pixmap( 48, 48 );
+            pixmap.fill( Qt::transparent );
+
+            QPainter painter( &pixmap );
+            painter.setRenderHint( QPainter::Antialiasing );
+            painter.setPen( Qt::NoPen );
+            painter.setBrush( QColor( 61, 174, 233 ) );
+            painter.drawEllipse( pixmap.rect().adjusted( 4, 4, -4, -4 ) );
+            return pixmap;
+        }() );
+
+        return icon;
+    }
+
+    //________________________________________________________________
+    QPalette MockClient::palette() const
+    { return QPalette(); }
+
+    //________________________________________________________________
+    QColor MockClient::color( ColorGroup group, ColorRole role ) const
+    {
+        const bool active( group == ColorGroup::Active );
+        switch( role )
+        {
+            case ColorRole::Frame: return active ? QColor( 71, 80, 87 ) : QColor( 239, 240, 241 );
+            case ColorRole::TitleBar: return active ? QColor( 71, 80, 87 ) : QColor( 239, 240, 241 );
+            case ColorRole::Foreground:
+            {
+                if( group == ColorGroup::Warning ) return QColor( 237, 21, 21 );
+                return active ? QColor( 252, 252, 252 ) : QColor( 189, 195, 199 );
+            }
+            default: return QColor();
+        }
+    }
+
+    //________________________________________________________________
+    MockSettings::MockSettings( KDecoration2::DecorationSettings* parent, const MockBridge* bridge ):
+        KDecoration2::DecorationSettingsPrivate( parent ),
+        m_bridge( bridge )
+    {
+        setGridUnit( 10 );
+        setSmallSpacing( 2 );
+        setLargeSpacing( 10 );
+    }
+
+    //________________________________________________________________
+    QVector<DecorationButtonType> MockSettings::decorationButtonsLeft() const
+    { return { DecorationButtonType::Menu, DecorationButtonType::OnAllDesktops }; }
+
+    //________________________________________________________________
+    QVector<DecorationButtonType> MockSettings::decorationButtonsRight() const
+    { return { DecorationButtonType::ContextHelp, DecorationButtonType::Minimize, DecorationButtonType::Maximize, DecorationButtonType::Close }; }
+
+    //________________________________________________________________
+    KDecoration2::BorderSize MockSettings::borderSize() const
+    { return m_bridge->borderSize; }
+
+    //________________________________________________________________
+    MockBridge::MockBridge( QObject* parent ):
+        KDecoration2::DecorationBridge( parent )
+    {}
+
+    //________________________________________________________________
+    Decoration* MockBridge::createDecoration()
+    {
+
+        const QVariantMap map( { { QStringLiteral( "bridge" ), QVariant::fromValue( static_cast<KDecoration2::DecorationBridge*>( this ) ) } } );
+        auto decoration = new Decoration( nullptr, QVariantList( { map } ) );
+        decoration->setSettings( decorationSettings() );
+
+        QElapsedTimer timer;
+        timer.start();
+        decoration->init();
+        initTime = timer.nsecsElapsed();
+
+        // settings are loaded in the background, and applied from the event loop
+        QThreadPool::globalInstance()->waitForDone();
+        QCoreApplication::processEvents();
+
+        return decoration;
+
+    }
+
+    //________________________________________________________________
+    QSharedPointer<KDecoration2::DecorationSettings> MockBridge::decorationSettings()
+    {
+
+        if( !m_settings || m_settingsBorderSize != borderSize )
+        {
+            m_settingsBorderSize = borderSize;
+            m_settings = QSharedPointer<KDecoration2::DecorationSettings>::create( this );
+        }
+
+        return m_settings;
+
+    }
+
+    //________________________________________________________________
+    std::unique_ptr<KDecoration2::DecoratedClientPrivate> MockBridge::createClient( KDecoration2::DecoratedClient* client, KDecoration2::Decoration* decoration )
+    { return std::unique_ptr<KDecoration2::DecoratedClientPrivate>( new MockClient( client, decoration, window ) ); }
+
+    //________________________________________________________________
+    std::unique_ptr<KDecoration2::DecorationSettingsPrivate> MockBridge::settings( KDecoration2::DecorationSettings* parent )
+    { return std::unique_ptr<KDecoration2::DecorationSettingsPrivate>( new MockSettings( parent, this ) ); }
+
+}
@@ -0,0 +1,167 @@
+#ifndef inspiremockbridge_h
+#define inspiremockbridge_h
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include <KDecoration2/DecorationSettings>
+#include <KDecoration2/Private/DecoratedClientPrivate>
+#include <KDecoration2/Private/DecorationBridge>
+#include <KDecoration2/Private/DecorationSettingsPrivate>
+
+#include <QSharedPointer>
+#include <QString>
+
+#include <memory>
+
+namespace Inspire
+{
+
+    class Decoration;
+    class MockBridge;
+
+    //* window state reported by mock clients
+    struct MockWindow
+    {
+        QString caption = QStringLiteral( "Mock window - Inspire decoration" );
+        int width = 800;
+        int height = 600;
+        bool active = true;
+        bool maximized = false;
+        bool shaded = false;
+        Qt::Edges adjacentScreenEdges;
+    };
+
+    //* decorated client, as kwin would provide it
+    class MockClient: public KDecoration2::DecoratedClientPrivate
+    {
+
+        public:
+
+        //* constructor
+        MockClient( KDecoration2::DecoratedClient*, KDecoration2::Decoration*, const MockWindow& );
+
+        //*@name window state
+        //@{
+        bool isActive() const override { return m_window.active; }
+        QString caption() const override { return m_window.caption; }
+        int desktop() const override { return 1; }
+        bool isOnAllDesktops() const override { return false; }
+        bool isShaded() const override { return m_window.shaded; }
+        QIcon icon() const override;
+        bool isMaximized() const override { return m_window.maximized; }
+        bool isMaximizedHorizontally() const override { return m_window.maximized; }
+        bool isMaximizedVertically() const override { return m_window.maximized; }
+        bool isKeepAbove() const override { return false; }
+        bool isKeepBelow() const override { return false; }
+        bool isCloseable() const override { return true; }
+        bool isMaximizeable() const override { return true; }
+        bool isMinimizeable() const override { return true; }
+        bool providesContextHelp() const override { return false; }
+        bool isModal() const override { return false; }
+        bool isShadeable() const override { return true; }
+        bool isMoveable() const override { return true; }
+        bool isResizeable() const override { return true; }
+        WId windowId() const override { return 0; }
+        WId decorationId() const override { return 0; }
+        int width() const override { return m_window.width; }
+        int height() const override { return m_window.height; }
+        QSize size() const override { return QSize( m_window.width, m_window.height ); }
+        QPalette palette() const override;
+        QColor color( KDecoration2::ColorGroup, KDecoration2::ColorRole ) const override;
+        Qt::Edges adjacentScreenEdges() const override { return m_window.adjacentScreenEdges; }
+        //@}
+
+        //*@name requests, ignored
+        //@{
+        void requestShowToolTip( const QString& ) override {}
+        void requestHideToolTip() override {}
+        void requestClose() override {}
+        void requestToggleMaximization( Qt::MouseButtons ) override {}
+        void requestMinimize() override {}
+        void requestContextHelp() override {}
+        void requestToggleOnAllDesktops() override {}
+        void requestToggleShade() override {}
+        void requestToggleKeepAbove() override {}
+        void requestToggleKeepBelow() override {}
+        void requestShowWindowMenu( const QRect& ) override {}
+        //@}
+
+        private:
+
+        MockWindow m_window;
+
+    };
+
+    //* decoration settings, as kwin would provide them
+    class MockSettings: public KDecoration2::DecorationSettingsPrivate
+    {
+
+        public:
+
+        //* constructor
+        MockSettings( KDecoration2::DecorationSettings*, const MockBridge* );
+
+        bool isAlphaChannelSupported() const override { return true; }
+        bool isOnAllDesktopsAvailable() const override { return true; }
+        bool isCloseOnDoubleClickOnMenu() const override { return false; }
+        QVector<KDecoration2::DecorationButtonType> decorationButtonsLeft() const override;
+        QVector<KDecoration2::DecorationButtonType> decorationButtonsRight() const override;
+        KDecoration2::BorderSize borderSize() const override;
+
+        private:
+
+        const MockBridge* m_bridge;
+
+    };
+
+    //* decoration bridge, to create and paint decorations without kwin
+    /**
+    decorations are created with the window state and border size currently set on the bridge.
+    Paint requests are ignored, decorations are painted explicitly
+    */
+    class MockBridge: public KDecoration2::DecorationBridge
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* constructor
+        explicit MockBridge( QObject* parent = nullptr );
+
+        //* window state used by the next created decoration
+        MockWindow window;
+
+        //* border size used by the next created settings
+        KDecoration2::BorderSize borderSize = KDecoration2::BorderSize::Normal;
+
+        //* time spent in init() by the last created decoration, in nanoseconds
+        qint64 initTime = 0;
+
+        //* create and initialize a decoration, using shared settings
+        /** settings loaded in the background are applied. Buttons and shadow are only created on first paint */
+        Decoration* createDecoration();
+
+        //* shared settings, recreated when border size changed
+        QSharedPointer<KDecoration2::DecorationSettings> decorationSettings();
+
+        //*@name bridge interface
+        //@{
+        std::unique_ptr<KDecoration2::DecoratedClientPrivate> createClient( KDecoration2::DecoratedClient*, KDecoration2::Decoration* ) override;
+        std::unique_ptr<KDecoration2::DecorationSettingsPrivate> settings( KDecoration2::DecorationSettings* ) override;
+        void update( KDecoration2::Decoration*, const QRect& ) override {}
+        //@}
+
+        private:
+
+        QSharedPointer<KDecoration2::DecorationSettings> m_settings;
+        KDecoration2::BorderSize m_settingsBorderSize = KDecoration2::BorderSize::Normal;
+
+    };
+
+}
+
+#endif
@@ -12,4 +12,8 @@
 /* Define to 1 if XCB libraries are found */
 #cmakedefine01 INSPIRE_HAVE_X11
 
+/* Plugin version, and hash of the settings defaults */
+#define INSPIRE_PLUGIN_VERSION "${PROJECT_VERSION}"
+#define INSPIRE_SETTINGS_DEFAULTS_HASH "${INSPIRE_SETTINGS_DEFAULTS_HASH}"
+
 #endif
@@ -9,8 +9,10 @@
 
 #include "inspireconfigwidget.h"
 #include "inspireexceptionlist.h"
+#include "inspiresettingscache.h"
 
 #include <KLocalizedString>
+#include <KPluginFactory>
 
 #include <QDBusConnection>
 #include <QDBusMessage>
@@ -95,16 +97,23 @@ namespace Inspire
         m_internalSettings->setShadowColor( m_ui.shadowColor->color() );
 
         // save configuration
+        const bool settingsChanged( m_internalSettings->isSaveNeeded() );
         m_internalSettings->save();
 
         // get list of exceptions and write
-        InternalSettingsList exceptions( m_ui.exceptions->exceptions() );
-        ExceptionList( exceptions ).writeConfig( m_configuration );
+        ExceptionSettingsList exceptions( m_ui.exceptions->exceptions() );
+        const bool exceptionsChanged( ExceptionList( exceptions ).writeConfig( m_configuration ) );
 
         // sync configuration
         m_configuration->sync();
         setChanged( false );
 
+        // nothing to reload if nothing was written
+        if( !( settingsChanged || exceptionsChanged ) ) return;
+
+        // update compiled settings snapshot, used by kwin at startup
+        SettingsCache::write( CompiledSettings::compile( *m_internalSettings, exceptions ) );
+
         // needed to tell kwin to reload when running from external kcmshell
         {
             QDBusMessage message = QDBusMessage::createSignal("/KWin", "org.kde.KWin", "reloadConfig");
@@ -175,3 +184,7 @@ namespace Inspire
     }
 
 }
+
+K_PLUGIN_CLASS_WITH_JSON(Inspire::ConfigWidget, "kcm_inspiredecoration.json")
+
+#include "inspireconfigwidget.moc"
@@ -9,8 +9,13 @@
 
 #include "inspireexceptiondialog.h"
 #include "inspiredetectwidget.h"
+#include "inspireexceptionprofiler.h"
 #include "config-inspire.h"
 
+#include <KLocalizedString>
+
+#include <QMessageBox>
+
 #if INSPIRE_HAVE_X11
 #include <QX11Info>
 #endif
@@ -52,7 +57,7 @@ namespace Inspire
     }
 
     //___________________________________________
-    void ExceptionDialog::setException( InternalSettingsPtr exception )
+    void ExceptionDialog::setException( ExceptionSettingsPtr exception )
     {
 
         // store exception internally
@@ -91,6 +96,32 @@ namespace Inspire
 
     }
 
+    //___________________________________________
+    void ExceptionDialog::accept()
+    {
+
+        // time pattern against open windows and long titles, and warn if slow
+        const QString pattern( m_ui.exceptionEditor->text() );
+        if( !pattern.isEmpty() )
+        {
+
+            const ExceptionProfiler::Result result( ExceptionProfiler().profile( m_ui.exceptionType->currentIndex(), pattern ) );
+            if( result.isSlow() )
+            {
+                QMessageBox messageBox( QMessageBox::Warning, i18n( "Warning - Inspire Settings" ),
+                    i18n( "This pattern takes up to %1 to match a single window, and may slow down window decoration.", ExceptionProfiler::formatTime( result.worstTime ) ),
+                    QMessageBox::Save | QMessageBox::Cancel, this );
+                messageBox.setInformativeText( i18n( "Consider anchoring the pattern, or avoiding nested repetitions." ) );
+                messageBox.setDefaultButton( QMessageBox::Cancel );
+                if( messageBox.exec() == QMessageBox::Cancel ) return;
+            }
+
+        }
+
+        QDialog::accept();
+
+    }
+
     //___________________________________________
     void ExceptionDialog::updateChanged()
     {
@@ -10,6 +10,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "ui_inspireexceptiondialog.h"
+#include "inspireexceptionlist.h"
 #include "inspire.h"
 
 #include <QCheckBox>
@@ -36,7 +37,7 @@ namespace Inspire
         {}
 
         //* set exception
-        void setException( InternalSettingsPtr );
+        void setException( ExceptionSettingsPtr );
 
         //* save exception
         void save();
@@ -50,6 +51,11 @@ namespace Inspire
         //* emitted when changed
         void changed( bool );
 
+        public Q_SLOTS:
+
+        //* accept, warning about slow patterns first
+        void accept() override;
+
         protected:
 
         //* set changed state
@@ -83,7 +89,7 @@ namespace Inspire
         CheckBoxMap m_checkboxes;
 
         //* internal exception
-        InternalSettingsPtr m_exception;
+        ExceptionSettingsPtr m_exception;
 
         //* detection dialog
         DetectDialog* m_detectDialog = nullptr;
@@ -9,6 +9,7 @@
 
 #include "inspireexceptionlistwidget.h"
 #include "inspireexceptiondialog.h"
+#include "inspireexceptionprofiler.h"
 
 #include <KLocalizedString>
 
@@ -17,6 +18,9 @@
 #include <QIcon>
 #include <QRegularExpression>
 
+#include <algorithm>
+#include <functional>
+
 //__________________________________________________________
 namespace Inspire
 {
@@ -42,12 +46,14 @@ namespace Inspire
         m_ui.addButton->setIcon( QIcon::fromTheme( QStringLiteral( "list-add" ) ) );
         m_ui.removeButton->setIcon( QIcon::fromTheme( QStringLiteral( "list-remove" ) ) );
         m_ui.editButton->setIcon( QIcon::fromTheme( QStringLiteral( "edit-rename" ) ) );
+        m_ui.profileButton->setIcon( QIcon::fromTheme( QStringLiteral( "chronometer" ) ) );
 
         connect( m_ui.addButton, &QAbstractButton::clicked, this, &ExceptionListWidget::add );
         connect( m_ui.editButton, &QAbstractButton::clicked, this, &ExceptionListWidget::edit );
         connect( m_ui.removeButton, &QAbstractButton::clicked, this, &ExceptionListWidget::remove );
         connect( m_ui.moveUpButton, &QAbstractButton::clicked, this, &ExceptionListWidget::up );
         connect( m_ui.moveDownButton, &QAbstractButton::clicked, this, &ExceptionListWidget::down );
+        connect( m_ui.profileButton, &QAbstractButton::clicked, this, &ExceptionListWidget::profile );
 
         connect( m_ui.exceptionListView, &QAbstractItemView::activated, this, &ExceptionListWidget::edit );
         connect( m_ui.exceptionListView, &QAbstractItemView::clicked, this, &ExceptionListWidget::toggle );
@@ -60,7 +66,7 @@ namespace Inspire
     }
 
     //__________________________________________________________
-    void ExceptionListWidget::setExceptions( const InternalSettingsList& exceptions )
+    void ExceptionListWidget::setExceptions( const ExceptionSettingsList& exceptions )
     {
         model().set( exceptions );
         resizeColumns();
@@ -68,7 +74,7 @@ namespace Inspire
     }
 
     //__________________________________________________________
-    InternalSettingsList ExceptionListWidget::exceptions()
+    ExceptionSettingsList ExceptionListWidget::exceptions()
     {
         return model().get();
         setChanged( false );
@@ -95,10 +101,7 @@ namespace Inspire
 
         QPointer<ExceptionDialog> dialog = new ExceptionDialog( this );
         dialog->setWindowTitle( i18n( "New Exception - Inspire Settings" ) );
-        InternalSettingsPtr exception( new InternalSettings() );
-
-        exception->load();
-
+        ExceptionSettingsPtr exception( new ExceptionSettings() );
         dialog->setException( exception );
 
         // run dialog and check existence
@@ -138,7 +141,7 @@ namespace Inspire
         QModelIndex current( m_ui.exceptionListView->selectionModel()->currentIndex() );
         if( ! model().contains( current ) ) return;
 
-        InternalSettingsPtr exception( model().get( current ) );
+        ExceptionSettingsPtr exception( model().get( current ) );
 
         // create dialog
         QPointer<ExceptionDialog> dialog( new ExceptionDialog( this ) );
@@ -196,7 +199,7 @@ namespace Inspire
         if( index.column() != ExceptionModel::ColumnEnabled ) return;
 
         // get matching exception
-        InternalSettingsPtr exception( model().get( index ) );
+        ExceptionSettingsPtr exception( model().get( index ) );
         exception->setEnabled( !exception->enabled() );
         setChanged( true );
 
@@ -206,42 +209,26 @@ namespace Inspire
     void ExceptionListWidget::up()
     {
 
-        InternalSettingsList selection( model().get( m_ui.exceptionListView->selectionModel()->selectedRows() ) );
-        if( selection.empty() ) { return; }
-
-        // retrieve selected indexes in list and store in model
         QModelIndexList selectedIndices( m_ui.exceptionListView->selectionModel()->selectedRows() );
-        InternalSettingsList selectedExceptions( model().get( selectedIndices ) );
+        if( selectedIndices.empty() ) { return; }
 
-        InternalSettingsList currentException( model().get() );
-        InternalSettingsList newExceptions;
+        QVector<int> rows;
+        for( const QModelIndex& index : qAsConst( selectedIndices ) ) rows.append( index.row() );
+        std::sort( rows.begin(), rows.end() );
 
-        for( InternalSettingsList::const_iterator iter = currentException.constBegin(); iter != currentException.constEnd(); ++iter )
+        // move each selected row above its previous, unless that one is selected and cannot move itself.
+        // Selection follows moved rows
+        int firstAvailable = 0;
+        for( int row : qAsConst( rows ) )
         {
-
-            // check if new list is not empty, current index is selected and last index is not.
-            // if yes, move.
-            if(
-                !( newExceptions.empty() ||
-                selectedIndices.indexOf( model().index( *iter ) ) == -1 ||
-                selectedIndices.indexOf( model().index( newExceptions.back() ) ) != -1
-                ) )
+            if( row > firstAvailable )
             {
-                InternalSettingsPtr last( newExceptions.back() );
-                newExceptions.removeLast();
-                newExceptions.append( *iter );
-                newExceptions.append( last );
-            } else newExceptions.append( *iter );
-
+                model().move( row, row - 1 );
+                firstAvailable = row;
+            } else firstAvailable = row + 1;
         }
 
-        model().set( newExceptions );
-
-        // restore selection
-        m_ui.exceptionListView->selectionModel()->select( model().index( selectedExceptions.front() ),  QItemSelectionModel::Clear|QItemSelectionModel::Select|QItemSelectionModel::Rows );
-        for( InternalSettingsList::const_iterator iter = selectedExceptions.constBegin(); iter != selectedExceptions.constEnd(); ++iter )
-        { m_ui.exceptionListView->selectionModel()->select( model().index( *iter ), QItemSelectionModel::Select|QItemSelectionModel::Rows ); }
-
+        updateButtons();
         setChanged( true );
 
     }
@@ -250,49 +237,50 @@ namespace Inspire
     void ExceptionListWidget::down()
     {
 
-        InternalSettingsList selection( model().get( m_ui.exceptionListView->selectionModel()->selectedRows() ) );
-        if( selection.empty() )
-        { return; }
-
-        // retrieve selected indexes in list and store in model
-        QModelIndexList selectedIndices( m_ui.exceptionListView->selectionModel()->selectedIndexes() );
-        InternalSettingsList selectedExceptions( model().get( selectedIndices ) );
+        QModelIndexList selectedIndices( m_ui.exceptionListView->selectionModel()->selectedRows() );
+        if( selectedIndices.empty() ) { return; }
 
-        InternalSettingsList currentExceptions( model().get() );
-        InternalSettingsList newExceptions;
+        QVector<int> rows;
+        for( const QModelIndex& index : qAsConst( selectedIndices ) ) rows.append( index.row() );
+        std::sort( rows.begin(), rows.end(), std::greater<int>() );
 
-        InternalSettingsListIterator iter( currentExceptions );
-        iter.toBack();
-        while( iter.hasPrevious() )
+        // move each selected row below its next, unless that one is selected and cannot move itself.
+        // Selection follows moved rows
+        int lastAvailable = model().rowCount() - 1;
+        for( int row : qAsConst( rows ) )
         {
+            if( row < lastAvailable )
+            {
+                model().move( row, row + 1 );
+                lastAvailable = row;
+            } else lastAvailable = row - 1;
+        }
 
-            InternalSettingsPtr current( iter.previous() );
+        updateButtons();
+        setChanged( true );
 
-            // check if new list is not empty, current index is selected and last index is not.
-            // if yes, move.
-            if(
-                !( newExceptions.empty() ||
-                selectedIndices.indexOf( model().index( current ) ) == -1 ||
-                selectedIndices.indexOf( model().index( newExceptions.front() ) ) != -1
-                ) )
-            {
+    }
 
-                InternalSettingsPtr first( newExceptions.front() );
-                newExceptions.removeFirst();
-                newExceptions.prepend( current );
-                newExceptions.prepend( first );
+    //_______________________________________________________
+    void ExceptionListWidget::profile()
+    {
 
-            } else newExceptions.prepend( current );
+        const ExceptionProfiler::ResultList results( ExceptionProfiler().profile( model().get() ) );
+        if( results.isEmpty() )
+        {
+            QMessageBox::information( this, i18n( "Profile Rules - Inspire Settings" ), i18n( "There are no enabled rules to profile." ) );
+            return;
         }
 
-        model().set( newExceptions );
+        const int slowCount = std::count_if( results.cbegin(), results.cend(), []( const ExceptionProfiler::Result& result ) { return result.isSlow(); } );
 
-        // restore selection
-        m_ui.exceptionListView->selectionModel()->select( model().index( selectedExceptions.front() ),  QItemSelectionModel::Clear|QItemSelectionModel::Select|QItemSelectionModel::Rows );
-        for( InternalSettingsList::const_iterator iter = selectedExceptions.constBegin(); iter != selectedExceptions.constEnd(); ++iter )
-        { m_ui.exceptionListView->selectionModel()->select( model().index( *iter ), QItemSelectionModel::Select|QItemSelectionModel::Rows ); }
+        QMessageBox messageBox( slowCount > 0 ? QMessageBox::Warning : QMessageBox::Information, i18n( "Profile Rules - Inspire Settings" ), QString(), QMessageBox::Close, this );
+        if( slowCount > 0 ) messageBox.setText( i18np( "One rule is slow to match, and may slow down window decoration.", "%1 rules are slow to match, and may slow down window decoration.", slowCount ) );
+        else messageBox.setText( i18np( "The enabled rule is fast to match.", "All %1 enabled rules are fast to match.", results.size() ) );
 
-        setChanged( true );
+        messageBox.setInformativeText( i18n( "Rules were matched against all open windows and long window titles. Slow rules take more than %1 for a single value.", ExceptionProfiler::formatTime( ExceptionProfiler::SlowThreshold ) ) );
+        messageBox.setDetailedText( ExceptionProfiler::report( results ) );
+        messageBox.exec();
 
     }
 
@@ -305,7 +293,7 @@ namespace Inspire
     }
 
     //_______________________________________________________
-    bool ExceptionListWidget::checkException( InternalSettingsPtr exception )
+    bool ExceptionListWidget::checkException( ExceptionSettingsPtr exception )
     {
 
         while( exception->exceptionPattern().isEmpty() || !QRegularExpression( exception->exceptionPattern() ).isValid() )
@@ -28,10 +28,10 @@ namespace Inspire
         explicit ExceptionListWidget( QWidget* = nullptr );
 
         //* set exceptions
-        void setExceptions( const InternalSettingsList& );
+        void setExceptions( const ExceptionSettingsList& );
 
         //* get exceptions
-        InternalSettingsList exceptions();
+        ExceptionSettingsList exceptions();
 
         //* true if changed
         virtual bool isChanged() const
@@ -75,13 +75,16 @@ namespace Inspire
         //* move down
         virtual void down();
 
+        //* profile enabled rules
+        virtual void profile();
+
         protected:
 
         //* resize columns
         void resizeColumns() const;
 
         //* check exception
-        bool checkException( InternalSettingsPtr );
+        bool checkException( ExceptionSettingsPtr );
 
         //* set changed state
         virtual void setChanged( bool value )
@@ -30,7 +30,7 @@ namespace Inspire
         if( !index.isValid() ) return QVariant();
 
         // retrieve associated file info
-        const InternalSettingsPtr& configuration( get(index) );
+        const ExceptionSettingsPtr& configuration( get(index) );
 
         // return text associated to file and column
         if( role == Qt::DisplayRole )
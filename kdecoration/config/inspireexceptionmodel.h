@@ -9,6 +9,7 @@
 // SPDX-License-Identifier: MIT
 //////////////////////////////////////////////////////////////////////////////
 
+#include "inspireexceptionlist.h"
 #include "inspirelistmodel.h"
 #include "inspiresettings.h"
 #include "inspire.h"
@@ -17,7 +18,7 @@ namespace Inspire
 {
 
     //* qlistview for object counters
-    class ExceptionModel: public ListModel<InternalSettingsPtr>
+    class ExceptionModel: public ListModel<ExceptionSettingsPtr>
     {
 
         public:
@@ -46,6 +47,10 @@ namespace Inspire
         int columnCount(const QModelIndex& ) const override
         { return nColumns; }
 
+        //* exceptions are ordered by priority, not sorted
+        bool hasSorting() const override
+        { return false; }
+
         //@}
 
         protected:
@@ -0,0 +1,163 @@
+//////////////////////////////////////////////////////////////////////////////
+// inspireexceptionprofiler.cpp
+// -------------------
+//
+// SPDX-FileCopyrightText: 2026 Inspire contributors
+//
+// SPDX-License-Identifier: MIT
+//////////////////////////////////////////////////////////////////////////////
+
+#include "inspireexceptionprofiler.h"
+#include "inspireexceptionmatcher.h"
+#include "config-inspire.h"
+
+#include <KLocalizedString>
+#include <KWindowInfo>
+#include <KWindowSystem>
+
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#if INSPIRE_HAVE_X11
+#include <QX11Info>
+#endif
+
+namespace Inspire
+{
+
+    //___________________________________________
+    ExceptionProfiler::ExceptionProfiler()
+    {
+
+        // captions and classes of currently open windows
+        #if INSPIRE_HAVE_X11
+        if( QX11Info::isPlatformX11() )
+        {
+            for( WId window : KWindowSystem::windows() )
+            {
+                const KWindowInfo info( window, NET::WMName, NET::WM2WindowClass );
+                if( !info.valid() ) continue;
+
+                m_titles.append( info.name() );
+                m_classes.append( QStringLiteral( "%1 %2" ).arg( QString::fromUtf8( info.windowClassName() ), QString::fromUtf8( info.windowClassClass() ) ) );
+            }
+        }
+        #endif
+
+        const QStringList pathological( pathologicalValues() );
+        m_titles.append( pathological );
+        m_classes.append( pathological );
+
+    }
+
+    //___________________________________________
+    const QStringList& ExceptionProfiler::samples( int type ) const
+    { return type == InternalSettings::ExceptionWindowTitle ? m_titles : m_classes; }
+
+    //___________________________________________
+    QStringList ExceptionProfiler::pathologicalValues()
+    {
+        return {
+            QString( 4096, QLatin1Char( 'a' ) ),
+            QString( 4096, QLatin1Char( 'a' ) ) + QLatin1Char( '!' ),
+            QStringLiteral( "a " ).repeated( 2048 ),
+            QStringLiteral( "/home/user/" ).repeated( 512 ) + QStringLiteral( "file.txt - Editor" ),
+            QStringLiteral( "Untitled - " ).repeated( 512 ),
+            QString( 2048, QChar( 0x00e9 ) ) + QString( 2048, QChar( 0x4e2d ) ),
+            QStringLiteral( "x\n" ).repeated( 1024 )
+        };
+    }
+
+    //___________________________________________
+    ExceptionProfiler::Result ExceptionProfiler::profile( int type, const QString& pattern ) const
+    {
+
+        Result result;
+        result.type = type;
+        result.pattern = pattern;
+
+        // use the same matcher as the decoration, so that timings are representative
+        ExceptionMatcher matcher;
+        matcher.addRule( 0, type, pattern );
+
+        QElapsedTimer timer;
+        for( const QString& value : samples( type ) )
+        {
+
+            // keep the fastest of several runs, so that scheduling hiccups are not reported as slow rules
+            bool matched = false;
+            qint64 elapsed = 0;
+            for( int run = 0; run < Runs; ++run )
+            {
+                timer.start();
+                matched = ( matcher.match( type, value ) >= 0 );
+                const qint64 runTime( timer.nsecsElapsed() );
+                if( run == 0 || runTime < elapsed ) elapsed = runTime;
+            }
+
+            ++result.samples;
+            if( matched ) ++result.matches;
+            result.totalTime += elapsed;
+            result.worstTime = qMax( result.worstTime, elapsed );
+
+        }
+
+        return result;
+
+    }
+
+    //___________________________________________
+    ExceptionProfiler::ResultList ExceptionProfiler::profile( const ExceptionSettingsList& exceptions ) const
+    {
+
+        ResultList results;
+        for( int index = 0; index < exceptions.size(); ++index )
+        {
+
+            const ExceptionSettingsPtr& exception( exceptions.at( index ) );
+            if( !exception->enabled() || exception->exceptionPattern().isEmpty() ) continue;
+
+            Result result( profile( exception->exceptionType(), exception->exceptionPattern() ) );
+            result.index = index;
+            results.append( result );
+
+        }
+
+        return results;
+
+    }
+
+    //___________________________________________
+    QString ExceptionProfiler::formatTime( qint64 time )
+    {
+        if( time >= 1000000 ) return i18n( "%1 ms", QString::number( time/1e6, 'f', 2 ) );
+        else if( time >= 1000 ) return i18n( "%1 µs", QString::number( time/1e3, 'f', 1 ) );
+        else return i18n( "%1 ns", time );
+    }
+
+    //___________________________________________
+    QString ExceptionProfiler::report( const ResultList& results )
+    {
+
+        QString out;
+        QTextStream stream( &out );
+        for( const Result& result : results )
+        {
+
+            const QString type( result.type == InternalSettings::ExceptionWindowTitle ? i18n( "Window Title" ) : i18n( "Window Class Name" ) );
+            stream
+                << ( result.isSlow() ? QStringLiteral( "[!] " ) : QStringLiteral( "    " ) )
+                << i18n( "Rule %1 (%2): %3", result.index + 1, type, result.pattern ) << '\n'
+                << "    "
+                << i18n( "average %1, worst %2, %3 of %4 values matched",
+                    formatTime( result.averageTime() ), formatTime( result.worstTime ),
+                    result.matches, result.samples )
+                << '\n';
+
+        }
+
+        return out;
+
+    }
+
+}
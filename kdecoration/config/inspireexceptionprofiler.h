@@ -0,0 +1,96 @@
+#ifndef inspireexceptionprofiler_h
+#define inspireexceptionprofiler_h
+//////////////////////////////////////////////////////////////////////////////
+// inspireexceptionprofiler.h
+// -------------------
+//
+// SPDX-FileCopyrightText: 2026 Inspire contributors
+//
+// SPDX-License-Identifier: MIT
+//////////////////////////////////////////////////////////////////////////////
+
+#include "inspireexceptionlist.h"
+#include "inspire.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace Inspire
+{
+
+    //* times exception rules against real and pathological window properties
+    class ExceptionProfiler
+    {
+
+        public:
+
+        //* worst match time above which a rule is reported as slow, in nanoseconds
+        static constexpr qint64 SlowThreshold = 500000;
+
+        //* number of times each value is matched. The fastest run is kept
+        static constexpr int Runs = 5;
+
+        //* profiling result for one rule
+        struct Result
+        {
+            //* exception index
+            int index = -1;
+
+            //* exception type and pattern
+            int type = 0;
+            QString pattern;
+
+            //* number of matched values and matches
+            int samples = 0;
+            int matches = 0;
+
+            //* total and worst match time, in nanoseconds, using the fastest run for each value
+            qint64 totalTime = 0;
+            qint64 worstTime = 0;
+
+            //* average match time
+            qint64 averageTime() const
+            { return samples > 0 ? totalTime/samples : 0; }
+
+            //* true if worst match time is over threshold
+            bool isSlow() const
+            { return worstTime > SlowThreshold; }
+        };
+
+        using ResultList = QVector<Result>;
+
+        //* constructor. Collects window captions and classes
+        ExceptionProfiler();
+
+        //* profile single rule
+        Result profile( int type, const QString& pattern ) const;
+
+        //* profile all enabled exceptions, by index
+        ResultList profile( const ExceptionSettingsList& ) const;
+
+        //* human readable report
+        static QString report( const ResultList& );
+
+        //* human readable time
+        static QString formatTime( qint64 );
+
+        private:
+
+        //* values to match rules against, by exception type
+        const QStringList& samples( int type ) const;
+
+        //* long titles, typical of catastrophic backtracking
+        static QStringList pathologicalValues();
+
+        //*@name samples
+        //@{
+        QStringList m_titles;
+        QStringList m_classes;
+        //@}
+
+    };
+
+}
+
+#endif
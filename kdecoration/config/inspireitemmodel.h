@@ -49,6 +49,11 @@ namespace Inspire
         const Qt::SortOrder& sortOrder() const
         { return m_sortOrder; }
 
+        //* true if the model keeps its items sorted
+        /** models that do not can report changes row by row, rather than through layout changes */
+        virtual bool hasSorting() const
+        { return true; }
+
         //@}
 
         protected:
@@ -11,8 +11,10 @@
 
 #include "inspireitemmodel.h"
 
+#include <QHash>
 #include <QSet>
 #include <QList>
+#include <QVector>
 
 #include <algorithm>
 
@@ -38,8 +40,8 @@ namespace Inspire
         typedef QListIterator<ValueType> ListIterator;
         typedef QMutableListIterator<ValueType> MutableListIterator;
 
-        //! list of vector
-        // typedef QSet<ValueType> Set;
+        //! set of values
+        typedef QSet<ValueType> Set;
 
         //! constructor
         ListModel(QObject *parent = nullptr):
@@ -83,6 +85,14 @@ namespace Inspire
         int rowCount(const QModelIndex &parent = QModelIndex()) const override
         { return parent.isValid() ? 0:_values.size(); }
 
+        //! sort
+        using ItemModel::sort;
+        void sort( int column, Qt::SortOrder order = Qt::AscendingOrder ) override
+        {
+            ItemModel::sort( column, order );
+            _resetRows();
+        }
+
         //@}
 
         //!@name selection
@@ -95,8 +105,9 @@ namespace Inspire
         //! store index internal selection state
         virtual void setIndexSelected( const QModelIndex& index, bool value )
         {
-            if( value ) _selection.push_back( get(index) );
-            else _selection.erase( std::remove( _selection.begin(), _selection.end(), get(index) ), _selection.end() );
+            if( !contains( index ) ) return;
+            if( value ) _selection.insert( get(index) );
+            else _selection.remove( get(index) );
         }
 
         //! get list of internal selected items
@@ -104,11 +115,13 @@ namespace Inspire
         {
 
             QModelIndexList out;
-            for( typename List::const_iterator iter = _selection.begin(); iter != _selection.end(); iter++ )
+            for( typename Set::const_iterator iter = _selection.begin(); iter != _selection.end(); iter++ )
             {
                 QModelIndex index( ListModel::index( *iter ) );
                 if( index.isValid() ) out.push_back( index );
             }
+
+            std::sort( out.begin(), out.end() );
             return out;
 
         }
@@ -120,16 +133,13 @@ namespace Inspire
 
         //! add value
         virtual void add( const ValueType& value )
-        {
-
-            emit layoutAboutToBeChanged();
-            _add( value );
-            privateSort();
-            emit layoutChanged();
-
-        }
+        { add( List() << value ); }
 
         //! add values
+        /*!
+        values already in the model are updated in place,
+        others are appended, unless the model is sorted
+        */
         virtual void add( const List& values )
         {
 
@@ -137,62 +147,116 @@ namespace Inspire
             // this avoids sending useless signals
             if( values.empty() ) return;
 
-            emit layoutAboutToBeChanged();
+            if( hasSorting() )
+            {
 
+                emit layoutAboutToBeChanged();
+
+                for( typename List::const_iterator iter = values.begin(); iter != values.end(); iter++ )
+                { _add( *iter ); }
+
+                privateSort();
+                _resetRows();
+                emit layoutChanged();
+                return;
+
+            }
+
+            // update existing values, and collect new ones
+            List newValues;
+            Set newValueSet;
             for( typename List::const_iterator iter = values.begin(); iter != values.end(); iter++ )
-            { _add( *iter ); }
+            {
 
-            privateSort();
-            emit layoutChanged();
+                const int row( _row( *iter ) );
+                if( row >= 0 )
+                {
 
-        }
+                    _values[row] = *iter;
+                    emit dataChanged( index( row, 0 ), index( row, columnCount( QModelIndex() ) - 1 ) );
 
+                } else if( !newValueSet.contains( *iter ) ) {
+
+                    newValueSet.insert( *iter );
+                    newValues.push_back( *iter );
+
+                }
+
+            }
+
+            if( newValues.empty() ) return;
+
+            // append new values as a single block
+            const int first( _values.size() );
+            beginInsertRows( QModelIndex(), first, first + newValues.size() - 1 );
+            for( typename List::const_iterator iter = newValues.constBegin(); iter != newValues.constEnd(); iter++ )
+            {
+                _rows.insert( *iter, _values.size() );
+                _values.push_back( *iter );
+            }
+            endInsertRows();
+
+        }
 
         //! insert values
         virtual void insert( const QModelIndex& index, const ValueType& value )
-        {
-            emit layoutAboutToBeChanged();
-            _insert( index, value );
-            emit layoutChanged();
-        }
+        { insert( index, List() << value ); }
 
         //! insert values
         virtual void insert( const QModelIndex& index, const List& values )
         {
-            emit layoutAboutToBeChanged();
+
+            if( values.empty() ) return;
+            if( !contains( index ) || hasSorting() )
+            {
+                add( values );
+                return;
+            }
+
+            const int first( index.row() );
+            beginInsertRows( QModelIndex(), first, first + values.size() - 1 );
 
             // need to loop in reverse order so that the "values" ordering is preserved
             ListIterator iter( values );
             iter.toBack();
             while( iter.hasPrevious() )
-            { _insert( index, iter.previous() ); }
+            { _values.insert( first, iter.previous() ); }
 
-            emit layoutChanged();
+            _indexRows( first, _values.size() - 1 );
+            endInsertRows();
 
         }
 
         //! insert values
         virtual void replace( const QModelIndex& index, const ValueType& value )
         {
-            if( !index.isValid() ) add( value );
+            if( !contains( index ) ) add( value );
             else {
-                emit layoutAboutToBeChanged();
-                setIndexSelected( index, false );
-                _values[index.row()] = value;
-                setIndexSelected( index, true );
-                emit layoutChanged();
+
+                const int row( index.row() );
+                const ValueType old( _values[row] );
+                _selection.remove( old );
+                _values[row] = value;
+
+                // old value may still be found further down
+                if( _rows.value( old, -1 ) == row )
+                {
+                    const int next( _values.indexOf( old, row + 1 ) );
+                    if( next >= 0 ) _rows.insert( old, next );
+                    else _rows.remove( old );
+                }
+
+                _indexRows( row, row );
+                _selection.insert( value );
+
+                emit dataChanged( this->index( row, 0 ), this->index( row, columnCount( QModelIndex() ) - 1 ) );
+
             }
         }
 
         //! remove
         virtual void remove( const ValueType& value )
-        {
-
-            emit layoutAboutToBeChanged();
-            _remove( value );
-            emit layoutChanged();
-
-        }
+        { remove( List() << value ); }
 
         //! remove
         virtual void remove( const List& values )
@@ -202,10 +266,54 @@ namespace Inspire
             // this avoids sending useless signals
             if( values.empty() ) return;
 
-            emit layoutAboutToBeChanged();
+            // collect rows
+            QVector<int> rows;
             for( typename List::const_iterator iter = values.begin(); iter != values.end(); iter++ )
-            { _remove( *iter ); }
-            emit layoutChanged();
+            {
+                const int row( _row( *iter ) );
+                if( row >= 0 ) rows.push_back( row );
+                _selection.remove( *iter );
+            }
+
+            if( rows.empty() ) return;
+
+            std::sort( rows.begin(), rows.end() );
+            rows.erase( std::unique( rows.begin(), rows.end() ), rows.end() );
+
+            // remove contiguous ranges, starting from the end so that remaining rows stay valid
+            for( int last = rows.size() - 1; last >= 0; )
+            {
+
+                int first = last;
+                while( first > 0 && rows[first-1] == rows[first] - 1 ) --first;
+
+                beginRemoveRows( QModelIndex(), rows[first], rows[last] );
+                _unindexRows( rows[first], rows[last] );
+                _values.erase( _values.begin() + rows[first], _values.begin() + rows[last] + 1 );
+                _indexRows( rows[first], _values.size() - 1 );
+                endRemoveRows();
+
+                last = first - 1;
+
+            }
+
+        }
+
+        //! move value from one row to another
+        virtual void move( int from, int to )
+        {
+
+            if( from == to || from < 0 || to < 0 || from >= _values.size() || to >= _values.size() ) return;
+
+            // destination is the row before which the value is moved, counted before the move
+            if( !beginMoveRows( QModelIndex(), from, from, QModelIndex(), to > from ? to + 1 : to ) ) return;
+
+            _values.move( from, to );
+
+            // only rows in between changed
+            _indexRows( qMin( from, to ), qMax( from, to ) );
+
+            endMoveRows();
 
         }
 
@@ -224,32 +332,36 @@ namespace Inspire
 
             emit layoutAboutToBeChanged();
 
-            // store values to be removed
-            List removed_values;
+            // index new values
+            QHash<ValueType, int> newRows;
+            for( int row = 0; row < values.size(); ++row )
+            { if( !newRows.contains( values[row] ) ) newRows.insert( values[row], row ); }
 
-            // update values that are common to both lists
-            for( typename List::iterator iter = _values.begin(); iter != _values.end(); iter++ )
+            // update values that are common to both lists, and drop the others
+            QVector<bool> used( values.size(), false );
+            List updated;
+            for( typename List::const_iterator iter = _values.constBegin(); iter != _values.constEnd(); iter++ )
             {
 
-                // see if iterator is in list
-                typename List::iterator found_iter( std::find( values.begin(), values.end(), *iter ) );
-                if( found_iter == values.end() ) removed_values.push_back( *iter );
-                else {
-                    *iter = *found_iter;
-                    values.erase( found_iter );
+                typename QHash<ValueType, int>::const_iterator found( newRows.constFind( *iter ) );
+                if( found == newRows.constEnd() ) _selection.remove( *iter );
+                else if( !used[found.value()] ) {
+                    updated.push_back( values[found.value()] );
+                    used[found.value()] = true;
                 }
 
             }
 
-            // remove values that have not been found in new list
-            for( typename List::const_iterator iter = removed_values.constBegin(); iter != removed_values.constEnd(); iter++ )
-            { _remove( *iter ); }
-
             // add remaining values
-            for( typename List::const_iterator iter = values.constBegin(); iter != values.constEnd(); iter++ )
-            { _add( *iter ); }
+            for( int row = 0; row < values.size(); ++row )
+            {
+                if( used[row] || newRows.value( values[row] ) != row ) continue;
+                updated.push_back( values[row] );
+            }
 
+            _values = updated;
             privateSort();
+            _resetRows();
             emit layoutChanged();
 
         }
@@ -258,12 +370,14 @@ namespace Inspire
         virtual void set( const List& values )
         {
 
-            emit layoutAboutToBeChanged();
+            beginResetModel();
             _values = values;
             _selection.clear();
             privateSort();
-            emit layoutChanged();
-       }
+            _resetRows();
+            endResetModel();
+
+        }
 
         //! return all values
         const List& get( void ) const
@@ -292,9 +406,8 @@ namespace Inspire
         //! return index associated to a given value
         virtual QModelIndex index( const ValueType& value, int column = 0 ) const
         {
-            for( int row = 0; row < _values.size(); ++row )
-            { if( value == _values[row] ) return index( row, column ); }
-            return QModelIndex();
+            const int row( _row( value ) );
+            return row >= 0 ? index( row, column ) : QModelIndex();
         }
 
         //@}
@@ -306,43 +419,91 @@ namespace Inspire
         protected:
 
         //! return all values
+        /*! row index is not updated. It is reset after privateSort, which is where values get reordered */
         List& _get( void )
         { return _values; }
 
         //! add, without update
         virtual void _add( const ValueType& value )
         {
-            typename List::iterator iter = std::find( _values.begin(), _values.end(), value );
-            if( iter == _values.end() ) _values.push_back( value );
-            else *iter = value;
+            const int row( _row( value ) );
+            if( row >= 0 ) _values[row] = value;
+            else {
+                _rows.insert( value, _values.size() );
+                _values.push_back( value );
+            }
         }
 
         //! add, without update
         virtual void _insert( const QModelIndex& index, const ValueType& value )
         {
-            if( !index.isValid() ) add( value );
-            int row = 0;
-            typename List::iterator iter( _values.begin() );
-            for( ;iter != _values.end() && row != index.row(); iter++, row++ )
-            {}
-
-            _values.insert( iter, value );
+            if( !contains( index ) ) _add( value );
+            else {
+                _values.insert( index.row(), value );
+                _indexRows( index.row(), _values.size() - 1 );
+            }
         }
 
         //! remove, without update
         virtual void _remove( const ValueType& value )
         {
-            _values.erase( std::remove( _values.begin(), _values.end(), value ), _values.end() );
-            _selection.erase( std::remove( _selection.begin(), _selection.end(), value ), _selection.end() );
+            const int row( _row( value ) );
+            if( row >= 0 )
+            {
+                _unindexRows( row, row );
+                _values.removeAt( row );
+                _indexRows( row, _values.size() - 1 );
+            }
+
+            _selection.remove( value );
         }
 
+        //! row for a given value, -1 if not found
+        /*! the first row wins when values are duplicated */
+        int _row( const ValueType& value ) const
+        { return _rows.value( value, -1 ); }
+
         private:
 
+        //! rebuild row index, after all values changed or were reordered
+        void _resetRows()
+        {
+            _rows.clear();
+            _rows.reserve( _values.size() );
+            _indexRows( 0, _values.size() - 1 );
+        }
+
+        //! update row index for values in given rows, after these were inserted, shifted or moved
+        /*!
+        entries pointing before the first row are kept, so that the first row wins when values are duplicated.
+        Entries of values that were removed must be dropped beforehand, using _unindexRows
+        */
+        void _indexRows( int first, int last )
+        {
+            for( int row = last; row >= first; --row )
+            {
+                typename QHash<ValueType, int>::iterator iter( _rows.find( _values[row] ) );
+                if( iter == _rows.end() ) _rows.insert( _values[row], row );
+                else if( iter.value() >= first ) iter.value() = row;
+            }
+        }
+
+        //! drop row index entries for values in given rows, before these are removed
+        void _unindexRows( int first, int last )
+        {
+            for( int row = first; row <= last; ++row )
+            { if( _rows.value( _values[row], -1 ) == row ) _rows.remove( _values[row] ); }
+        }
+
+
         //! values
         List _values;
 
         //! selection
-        List _selection;
+        Set _selection;
+
+        //! row index, by value. Only rows after an edit point are updated
+        QHash<ValueType, int> _rows;
 
     };
 }
@@ -9,6 +9,7 @@
 
 #include "inspiresettings.h"
 
+#include <QFlags>
 #include <QSharedPointer>
 #include <QList>
 #include <KDecoration2/DecorationSettings>
@@ -36,6 +37,9 @@ namespace Inspire
         // shadow dimensions (pixels)
         static constexpr int Shadow_Overlap = 3;
 
+        // size grip width, for borderless windows (pixels)
+        static constexpr int SizeGrip_Width = 14;
+
     }
 
     //* standard pen widths
@@ -55,6 +59,22 @@ namespace Inspire
         None = 0,
         BorderSize = 1<<4,
     };
+
+    //* settings changes, used to only update what is affected by a reconfiguration
+    enum SettingsChange
+    {
+        NoChange = 0,
+        BorderChange = 1<<0,
+        ShadowChange = 1<<1,
+        ButtonChange = 1<<2,
+        TitleBarChange = 1<<3,
+        AnimationChange = 1<<4,
+        AllChanges = BorderChange|ShadowChange|ButtonChange|TitleBarChange|AnimationChange
+    };
+
+    Q_DECLARE_FLAGS( SettingsChanges, SettingsChange )
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS( Inspire::SettingsChanges )
+
 #endif
@@ -7,6 +7,7 @@
  * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
  */
 #include "inspirebutton.h"
+#include "inspireprofiler.h"
 
 #include <KDecoration2/DecoratedClient>
 #include <KColorUtils>
@@ -16,6 +17,55 @@
 #include <QPainter>
 #include <QVariantAnimation>
 #include <QPainterPath>
+#include <QPixmapCache>
+
+namespace
+{
+
+    //* rasterize application icon, colorized with given color
+    /**
+    the result is cached per icon, size, device pixel ratio, color and the palette colors
+    used to recolor symbolic icons, so that KIconLoader's custom palette is only altered on cache misses,
+    and color scheme changes do not hit stale entries
+    */
+    QPixmap iconPixmap( const QIcon& icon, const QSize& size, qreal devicePixelRatio, const QColor& color, QPalette palette )
+    {
+
+        const QString key( QStringLiteral( "inspire-menu-icon-%1-%2x%3-%4-%5-%6-%7-%8" )
+            .arg( icon.cacheKey() )
+            .arg( size.width() )
+            .arg( size.height() )
+            .arg( devicePixelRatio )
+            .arg( color.rgba() )
+            .arg( palette.color( QPalette::Window ).rgba() )
+            .arg( palette.color( QPalette::Highlight ).rgba() )
+            .arg( palette.color( QPalette::HighlightedText ).rgba() ) );
+
+        QPixmap pixmap;
+        if( QPixmapCache::find( key, &pixmap ) ) return pixmap;
+
+        pixmap = QPixmap( size*devicePixelRatio );
+        pixmap.setDevicePixelRatio( devicePixelRatio );
+        pixmap.fill( Qt::transparent );
+
+        // colorize symbolic icons using font color
+        const QPalette activePalette = KIconLoader::global()->customPalette();
+        palette.setColor( QPalette::WindowText, color );
+        KIconLoader::global()->setCustomPalette( palette );
+
+        QPainter painter( &pixmap );
+        icon.paint( &painter, QRect( QPoint( 0, 0 ), size ) );
+        painter.end();
+
+        if( activePalette == QPalette() ) KIconLoader::global()->resetPalette();
+        else KIconLoader::global()->setCustomPalette( activePalette );
+
+        QPixmapCache::insert( key, pixmap );
+        return pixmap;
+
+    }
+
+}
 
 namespace Inspire
 {
@@ -28,18 +78,8 @@ namespace Inspire
     //__________________________________________________________________
     Button::Button(DecorationButtonType type, Decoration* decoration, QObject* parent)
         : DecorationButton(type, decoration, parent)
-        , m_animation( new QVariantAnimation( this ) )
     {
 
-        // setup animation
-        // It is important start and end value are of the same type, hence 0.0 and not just 0
-        m_animation->setStartValue( 0.0 );
-        m_animation->setEndValue( 1.0 );
-        m_animation->setEasingCurve( QEasingCurve::InOutQuad );
-        connect(m_animation, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
-            setOpacity(value.toReal());
-        });
-
         // setup default geometry
         const int height = decoration->buttonHeight();
         const int width = height * (type == DecorationButtonType::Menu ? 1.0 : 1.2);
@@ -47,7 +87,10 @@ namespace Inspire
         setIconSize(QSize( height, height ));
 
         // connections
-        connect(decoration->client().toStrongRef().data(), SIGNAL(iconChanged(QIcon)), this, SLOT(update()));
+        // only the menu button depends on the application icon
+        if( type == DecorationButtonType::Menu )
+        { connect(decoration->client().toStrongRef().data(), &KDecoration2::DecoratedClient::iconChanged, this, [this]() { update(); }); }
+
         connect(decoration->settings().data(), &KDecoration2::DecorationSettings::reconfigured, this, &Button::reconfigure);
         connect( this, &KDecoration2::DecorationButton::hoveredChanged, this, &Button::updateAnimationState );
 
@@ -100,10 +143,6 @@ namespace Inspire
                 QObject::connect(c.data(), &KDecoration2::DecoratedClient::shadeableChanged, b, &Inspire::Button::setVisible );
                 break;
 
-                case DecorationButtonType::Menu:
-                QObject::connect(c.data(), &KDecoration2::DecoratedClient::iconChanged, b, [b]() { b->update(); });
-                break;
-
                 default: break;
 
             }
@@ -118,10 +157,21 @@ namespace Inspire
     //__________________________________________________________________
     void Button::paint(QPainter *painter, const QRect &repaintRegion)
     {
-        Q_UNUSED(repaintRegion)
-
         if (!decoration()) return;
 
+        const auto owner = qobject_cast<Decoration*>( decoration() );
+        const Profiler::Scope profile( Profiler::ButtonPaint, owner ? owner->profileId() : 0 );
+
+        // do nothing if the button does not intersect the repaint region
+        if( repaintRegion.isValid() )
+        {
+            const QRectF paintRect( m_flag == FlagFirstInList ?
+                geometry().translated( m_offset ):
+                geometry().translated( 0, m_offset.y() ) );
+
+            if( !paintRect.united( geometry() ).toAlignedRect().intersects( repaintRegion ) ) return;
+        }
+
         painter->save();
 
         // translate from offset
@@ -141,21 +191,13 @@ namespace Inspire
             int iconlocation = ( (m_iconSize.height() / 2) - (iconpixelsize / 2) );
             // Set the X location for the icon... if Y is used instead the icon will be permanently stuck to the left
             int iconlocationx = (geometry().topLeft().x() + iconlocation);
-            const QRectF iconRect( iconlocationx, iconlocation, iconpixelsize, iconpixelsize );
+            const QRect iconRect( iconlocationx, iconlocation, iconpixelsize, iconpixelsize );
             const auto c = decoration()->client().toStrongRef();
             if (auto deco =  qobject_cast<Decoration*>(decoration())) {
-                const QPalette activePalette = KIconLoader::global()->customPalette();
-                QPalette palette = c->palette();
-                palette.setColor(QPalette::WindowText, deco->fontColor());
-                KIconLoader::global()->setCustomPalette(palette);
-                c->icon().paint(painter, iconRect.toRect());
-                if (activePalette == QPalette()) {
-                    KIconLoader::global()->resetPalette();
-                }    else {
-                    KIconLoader::global()->setCustomPalette(palette);
-                }
+                const qreal devicePixelRatio = painter->device()->devicePixelRatioF();
+                painter->drawPixmap( iconRect, iconPixmap( c->icon(), iconRect.size(), devicePixelRatio, deco->fontColor(), c->palette() ) );
             } else {
-                c->icon().paint(painter, iconRect.toRect());
+                c->icon().paint(painter, iconRect);
             }
 
         } else {
@@ -648,7 +690,7 @@ namespace Inspire
 
             return d->fontColor();
 
-        } else if( m_animation->state() == QAbstractAnimation::Running ) {
+        } else if( m_animation && m_animation->state() == QAbstractAnimation::Running ) {
 
             if( type() == DecorationButtonType::Close ) {
                 QColor color(255,255,255);
@@ -701,7 +743,7 @@ namespace Inspire
 
             return KColorUtils::darken( btnColor, 0.14 );
 
-        } else if( m_animation->state() == QAbstractAnimation::Running ) {
+        } else if( m_animation && m_animation->state() == QAbstractAnimation::Running ) {
 
             if( type() == DecorationButtonType::Close )
             {
@@ -745,7 +787,7 @@ namespace Inspire
 
         // animation
         auto d = qobject_cast<Decoration*>(decoration());
-        if( d )  m_animation->setDuration( d->animationsDuration() );
+        if( d && m_animation ) m_animation->setDuration( d->animationsDuration() );
 
     }
 
@@ -756,6 +798,20 @@ namespace Inspire
         auto d = qobject_cast<Decoration*>(decoration());
         if( !(d && d->animationsDuration() > 0 ) ) return;
 
+        // animation is created on first hover
+        if( !m_animation )
+        {
+            // It is important start and end value are of the same type, hence 0.0 and not just 0
+            m_animation = new QVariantAnimation( this );
+            m_animation->setStartValue( 0.0 );
+            m_animation->setEndValue( 1.0 );
+            m_animation->setEasingCurve( QEasingCurve::InOutQuad );
+            m_animation->setDuration( d->animationsDuration() );
+            connect(m_animation, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
+                setOpacity(value.toReal());
+            });
+        }
+
         m_animation->setDirection( hovered ? QAbstractAnimation::Forward : QAbstractAnimation::Backward );
         if( m_animation->state() != QAbstractAnimation::Running ) m_animation->start();
 
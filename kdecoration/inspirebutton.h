@@ -73,8 +73,11 @@ namespace Inspire
         void setOpacity( qreal value )
         {
             if( m_opacity == value ) return;
+
+            // only repaint when the rendered alpha actually changes
+            const bool changed( qRound( m_opacity*255 ) != qRound( value*255 ) );
             m_opacity = value;
-            update();
+            if( changed ) update();
         }
 
         qreal opacity() const
@@ -106,8 +109,8 @@ namespace Inspire
 
         Flag m_flag = FlagNone;
 
-        //* active state change animation
-        QVariantAnimation *m_animation;
+        //* active state change animation, created on first hover
+        QVariantAnimation *m_animation = nullptr;
 
         //* vertical offset (for rendering)
         QPointF m_offset;
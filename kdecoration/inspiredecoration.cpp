@@ -12,30 +12,31 @@
 
 #include "inspiresettingsprovider.h"
 #include "config-inspire.h"
-#include "config/inspireconfigwidget.h"
 
 #include "inspirebutton.h"
-#include "inspiresizegrip.h"
 
 #include "inspireboxshadowrenderer.h"
+#include "inspireprofiler.h"
 
 #include <KDecoration2/DecorationButtonGroup>
 #include <KDecoration2/DecorationShadow>
 
-#include <KConfigGroup>
 #include <KColorUtils>
-#include <KSharedConfig>
 #include <KPluginFactory>
 
+#include <QDateTime>
+#include <QHash>
+#include <QMetaObject>
 #include <QPainter>
 #include <QTextStream>
 #include <QTimer>
-#include <QDBusConnection>
 
 #if INSPIRE_HAVE_X11
+#include <KWindowInfo>
 #include <QX11Info>
 #endif
 
+#include <algorithm>
 #include <cmath>
 
 K_PLUGIN_FACTORY_WITH_JSON(
@@ -43,7 +44,6 @@ K_PLUGIN_FACTORY_WITH_JSON(
     "inspire.json",
     registerPlugin<Inspire::Decoration>();
     registerPlugin<Inspire::Button>();
-    registerPlugin<Inspire::ConfigWidget>();
 )
 
 namespace
@@ -141,14 +141,13 @@ namespace Inspire
     static int g_shadowSizeEnum = InternalSettings::ShadowLarge;
     static int g_shadowStrength = 255;
     static QColor g_shadowColor = Qt::black;
-    static QSharedPointer<KDecoration2::DecorationShadow> g_sShadow;
-    static QSharedPointer<KDecoration2::DecorationShadow> g_sShadowInactive;
+
+    //* shared shadows, by active state and trimmed screen edges. See Decoration::shadowKey
+    static QHash<int, QSharedPointer<KDecoration2::DecorationShadow>> g_sShadows;
 
     //________________________________________________________________
     Decoration::Decoration(QObject *parent, const QVariantList &args)
         : KDecoration2::Decoration(parent, args)
-        , m_animation( new QVariantAnimation( this ) )
-        , m_shadowAnimation( new QVariantAnimation( this ) )
     {
         g_sDecoCount++;
     }
@@ -156,13 +155,16 @@ namespace Inspire
     //________________________________________________________________
     Decoration::~Decoration()
     {
+        SettingsProvider::self()->unregisterDecoration( this );
+
         g_sDecoCount--;
         if (g_sDecoCount == 0) {
-            // last deco destroyed, clean up shadow
-            g_sShadow.clear();
-        }
+            // last deco destroyed, clean up shadows
+            g_sShadows.clear();
 
-        deleteSizeGrip();
+            // memory should be back to its baseline at this point
+            if( Profiler::isEnabled() ) Profiler::report();
+        }
 
     }
 
@@ -172,8 +174,6 @@ namespace Inspire
         if( m_opacity == value ) return;
         m_opacity = value;
         update();
-
-        if( m_sizeGrip ) m_sizeGrip->update();
     }
 
     //________________________________________________________________
@@ -182,7 +182,7 @@ namespace Inspire
 
         const auto c = client().toStrongRef();
         if( hideTitleBar() ) return c->color( ColorGroup::Inactive, ColorRole::TitleBar );
-        else if( m_animation->state() == QAbstractAnimation::Running )
+        else if( m_animation && m_animation->state() == QAbstractAnimation::Running )
         {
             return KColorUtils::mix(
                 c->color( ColorGroup::Inactive, ColorRole::TitleBar ),
@@ -197,7 +197,7 @@ namespace Inspire
     {
 
         const auto c = client().toStrongRef();
-        if( m_animation->state() == QAbstractAnimation::Running )
+        if( m_animation && m_animation->state() == QAbstractAnimation::Running )
         {
             return KColorUtils::mix(
                 c->color( ColorGroup::Inactive, ColorRole::Foreground ),
@@ -207,41 +207,64 @@ namespace Inspire
 
     }
 
+    //________________________________________________________________
+    QString Decoration::windowClass() const
+    {
+
+        if( !m_windowClassResolved )
+        {
+
+            m_windowClassResolved = true;
+
+            // the decorated client does not expose the window class,
+            // so it is queried once from the window system, on X11 only
+            QByteArray className;
+            QByteArray classClass;
+
+            #if INSPIRE_HAVE_X11
+            const auto c = client().toStrongRef();
+            if( c && c->windowId() != 0 && QX11Info::isPlatformX11() )
+            {
+                KWindowInfo info( c->windowId(), {}, NET::WM2WindowClass );
+                className = info.windowClassName();
+                classClass = info.windowClassClass();
+            }
+            #endif
+
+            m_windowClass = QString::fromUtf8( className ) + QStringLiteral(" ") + QString::fromUtf8( classClass );
+
+        }
+
+        return m_windowClass;
+
+    }
+
+    //________________________________________________________________
+    quint64 Decoration::profileId() const
+    {
+        if( !Profiler::isEnabled() ) return 0;
+        const auto c = client().toStrongRef();
+        return c ? c->windowId() : 0;
+    }
+
     //________________________________________________________________
     void Decoration::init()
     {
+        const Profiler::Scope profile( Profiler::DecorationInit, profileId() );
         const auto c = client().toStrongRef();
-        
-        // active state change animation
-        // It is important start and end value are of the same type, hence 0.0 and not just 0
-        m_animation->setStartValue( 0.0 );
-        m_animation->setEndValue( 1.0 );
-        // Linear to have the same easing as Inspire animations
-        m_animation->setEasingCurve( QEasingCurve::Linear );
-        connect(m_animation, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
-            setOpacity(value.toReal());
-        });
-
-        m_shadowAnimation->setStartValue( 0.0 );
-        m_shadowAnimation->setEndValue( 1.0 );
-        m_shadowAnimation->setEasingCurve( QEasingCurve::OutCubic );
-        connect(m_shadowAnimation, &QVariantAnimation::valueChanged, this, [this](const QVariant& value) {
-            m_shadowOpacity = value.toReal();
-            updateShadow();
-        });
 
-        // use DBus connection to update on inspire configuration change
-        auto dbus = QDBusConnection::sessionBus();
-        dbus.connect( QString(),
-            QStringLiteral( "/KGlobalSettings" ),
-            QStringLiteral( "org.kde.KGlobalSettings" ),
-            QStringLiteral( "notifyChange" ), this, SLOT(reconfigure()) );
+        // settings provider tracks configuration changes, including global settings, once for all decorations,
+        // and only notifies decorations whose settings actually changed
+        SettingsProvider::self()->registerDecoration( this );
 
         reconfigure();
         updateTitleBar();
         auto s = settings();
         connect(s.data(), &KDecoration2::DecorationSettings::borderSizeChanged, this, &Decoration::recalculateBorders);
 
+        // size grip is only drawn with compositing
+        connect(s.data(), &KDecoration2::DecorationSettings::alphaChannelSupportedChanged, this, &Decoration::recalculateBorders);
+
         // a change in font might cause the borders to change
         connect(s.data(), &KDecoration2::DecorationSettings::fontChanged, this, &Decoration::recalculateBorders);
         connect(s.data(), &KDecoration2::DecorationSettings::spacingChanged, this, &Decoration::recalculateBorders);
@@ -251,20 +274,24 @@ namespace Inspire
         connect(s.data(), &KDecoration2::DecorationSettings::decorationButtonsLeftChanged, this, &Decoration::updateButtonsGeometryDelayed);
         connect(s.data(), &KDecoration2::DecorationSettings::decorationButtonsRightChanged, this, &Decoration::updateButtonsGeometryDelayed);
 
-        // full reconfiguration
-        connect(s.data(), &KDecoration2::DecorationSettings::reconfigured, this, &Decoration::reconfigure);
+        // full reconfiguration, forwarded to decorations by the settings provider.
+        // Buttons are only laid out again if their settings changed, see applySettings
         connect(s.data(), &KDecoration2::DecorationSettings::reconfigured, SettingsProvider::self(), &SettingsProvider::reconfigure, Qt::UniqueConnection );
-        connect(s.data(), &KDecoration2::DecorationSettings::reconfigured, this, &Decoration::updateButtonsGeometryDelayed);
 
         connect(c.data(), &KDecoration2::DecoratedClient::adjacentScreenEdgesChanged, this, &Decoration::recalculateBorders);
         connect(c.data(), &KDecoration2::DecoratedClient::maximizedHorizontallyChanged, this, &Decoration::recalculateBorders);
         connect(c.data(), &KDecoration2::DecoratedClient::maximizedVerticallyChanged, this, &Decoration::recalculateBorders);
         connect(c.data(), &KDecoration2::DecoratedClient::shadedChanged, this, &Decoration::recalculateBorders);
+        connect(c.data(), &KDecoration2::DecoratedClient::resizeableChanged, this, &Decoration::recalculateBorders);
+        connect(c.data(), &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::recalculateBorders);
         connect(c.data(), &KDecoration2::DecoratedClient::captionChanged, this,
             [this]()
             {
-                // update the caption area
-                update(titleBar());
+                // title exceptions may apply to the new caption
+                SettingsProvider::self()->updateCaption( this );
+
+                // update the previous and new caption areas, leaving buttons alone
+                update( m_captionRect.united( captionRect().first ) );
             }
         );
 
@@ -278,6 +305,17 @@ namespace Inspire
         connect(c.data(), &KDecoration2::DecoratedClient::adjacentScreenEdgesChanged, this, &Decoration::updateButtonsGeometry);
         connect(c.data(), &KDecoration2::DecoratedClient::shadedChanged, this, &Decoration::updateButtonsGeometry);
 
+        // shadow is dropped for maximized windows, and trimmed on screen edges
+        connect(c.data(), &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::updateShadow);
+        connect(c.data(), &KDecoration2::DecoratedClient::adjacentScreenEdgesChanged, this, &Decoration::updateShadow);
+
+        // buttons and shadow are created on first paint, see initDeferred. Animations are created when first needed
+    }
+
+    //________________________________________________________________
+    void Decoration::initDeferred()
+    {
+        m_initialized = true;
         createButtons();
         updateShadow();
     }
@@ -298,9 +336,21 @@ namespace Inspire
     //________________________________________________________________
     void Decoration::updateAnimationState()
     {
-        if( m_shadowAnimation->duration() > 0 )
+        if( m_shadowAnimationDuration > 0 )
         {
 
+            if( !m_shadowAnimation )
+            {
+                m_shadowAnimation = new QVariantAnimation( this );
+                m_shadowAnimation->setStartValue( 0.0 );
+                m_shadowAnimation->setEndValue( 1.0 );
+                m_shadowAnimation->setDuration( m_shadowAnimationDuration );
+                connect(m_shadowAnimation, &QVariantAnimation::valueChanged, this, [this](const QVariant& value) {
+                    m_shadowOpacity = value.toReal();
+                    updateShadow();
+                });
+            }
+
             const auto c = client().toStrongRef();
             m_shadowAnimation->setDirection( c->isActive() ? QAbstractAnimation::Forward : QAbstractAnimation::Backward );
             m_shadowAnimation->setEasingCurve( c->isActive() ? QEasingCurve::OutCubic : QEasingCurve::InCubic );
@@ -312,9 +362,24 @@ namespace Inspire
 
         }
 
-        if( m_animation->duration() > 0 )
+        if( m_animationDuration > 0 )
         {
 
+            if( !m_animation )
+            {
+                // active state change animation
+                // It is important start and end value are of the same type, hence 0.0 and not just 0
+                m_animation = new QVariantAnimation( this );
+                m_animation->setStartValue( 0.0 );
+                m_animation->setEndValue( 1.0 );
+                // Linear to have the same easing as Inspire animations
+                m_animation->setEasingCurve( QEasingCurve::Linear );
+                m_animation->setDuration( m_animationDuration );
+                connect(m_animation, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
+                    setOpacity(value.toReal());
+                });
+            }
+
             const auto c = client().toStrongRef();
             m_animation->setDirection( c->isActive() ? QAbstractAnimation::Forward : QAbstractAnimation::Backward );
             if( m_animation->state() != QAbstractAnimation::Running ) m_animation->start();
@@ -326,21 +391,13 @@ namespace Inspire
         }
     }
 
-    //________________________________________________________________
-    void Decoration::updateSizeGripVisibility()
-    {
-        const auto c = client().toStrongRef();
-        if( m_sizeGrip )
-        { m_sizeGrip->setVisible( c->isResizeable() && !isMaximized() && !c->isShaded() ); }
-    }
-
     //________________________________________________________________
     int Decoration::borderSize(bool bottom) const
     {
         const int baseSize = settings()->smallSpacing();
-        if( m_internalSettings && (m_internalSettings->mask() & BorderSize ) )
+        if( m_settings && m_settings->hasBorderSize() )
         {
-            switch (m_internalSettings->borderSize()) {
+            switch (m_settings->borderSize()) {
                 case InternalSettings::BorderNone: return 0;
                 case InternalSettings::BorderNoSides: return bottom ? qMax(4, baseSize) : 0;
                 default:
@@ -375,46 +432,65 @@ namespace Inspire
     //________________________________________________________________
     void Decoration::reconfigure()
     {
+        const Profiler::Scope profile( Profiler::DecorationReconfigure, profileId() );
 
-        m_internalSettings = SettingsProvider::self()->internalSettings( this );
-        
         setScaledCornerRadius();
+        applySettings( SettingsProvider::self()->effectiveSettings( this ), AllChanges );
+
+    }
+
+    //________________________________________________________________
+    void Decoration::applySettings( EffectiveSettingsPtr settings, SettingsChanges changes )
+    {
+
+        m_settings = settings;
+        if( !changes ) return;
 
         // animation
+        if( changes & AnimationChange )
+        {
+            const qreal animationDurationFactor = SettingsProvider::self()->animationDurationFactor();
+
+            m_animationDuration = 0;
+            // Syncing anis between client and decoration is troublesome, so we're not using
+            // any animations right now.
+            // m_animationDuration = animationDurationFactor * 100.0f;
 
-        KSharedConfig::Ptr config = KSharedConfig::openConfig();
-        const KConfigGroup cg(config, QStringLiteral("KDE"));
+            // But the shadow is fine to animate like this!
+            m_shadowAnimationDuration = animationDurationFactor * 100.0f;
+
+            // animations are created on first use, only update existing ones
+            if( m_animation ) m_animation->setDuration( m_animationDuration );
+            if( m_shadowAnimation ) m_shadowAnimation->setDuration( m_shadowAnimationDuration );
+        }
 
-        m_animation->setDuration(0);
-        // Syncing anis between client and decoration is troublesome, so we're not using
-        // any animations right now.
-        // m_animation->setDuration( cg.readEntry("AnimationDurationFactor", 1.0f) * 100.0f );
+        // borders, including size grip
+        if( changes & BorderChange ) recalculateBorders();
 
-        // But the shadow is fine to animate like this!
-        m_shadowAnimation->setDuration( cg.readEntry("AnimationDurationFactor", 1.0f) * 100.0f );
+        // title bar depends on borders
+        if( changes & ( BorderChange|TitleBarChange ) ) updateTitleBar();
 
-        // borders
-        recalculateBorders();
+        // buttons, if already created
+        if( ( changes & ButtonChange ) && m_leftButtons ) updateButtonsGeometryDelayed();
 
         // shadow
-        updateShadow();
+        if( changes & ShadowChange ) updateShadow();
 
-        // size grip
-        if( hasNoBorders() && m_internalSettings->drawSizeGrip() ) createSizeGrip();
-        else deleteSizeGrip();
+        update();
 
     }
 
     //________________________________________________________________
     void Decoration::recalculateBorders()
     {
+        const Profiler::Scope profile( Profiler::RecalculateBorders, profileId() );
         const auto c = client().toStrongRef();
         auto s = settings();
 
         // left, right and bottom borders
         const int left   = isLeftEdge() ? 0 : borderSize();
         const int right  = isRightEdge() ? 0 : borderSize();
-        const int bottom = (c->isShaded() || isBottomEdge()) ? 0 : borderSize(true);
+        int bottom = (c->isShaded() || isBottomEdge()) ? 0 : borderSize(true);
 
         int top = 0;
         if( hideTitleBar() ) top = bottom;
@@ -433,6 +509,12 @@ namespace Inspire
 
         }
 
+        // size grip needs room below the window. This adds a transparent strip along the whole bottom,
+        // that is part of the frame geometry and input shape, since kwin decorations cannot paint
+        // in resize-only borders. It is only added with compositing, see hasSizeGrip
+        const bool sizeGrip( hasSizeGrip() );
+        if( sizeGrip ) bottom = qMax( bottom, int( Metrics::SizeGrip_Width ) );
+
         setBorders(QMargins(left, top, right, bottom));
 
         // extended sizes
@@ -450,6 +532,13 @@ namespace Inspire
 
         }
 
+        // resizing from the grip goes through resize-only borders, that extend past the painted one
+        if( sizeGrip )
+        {
+            extSides = qMax( extSides, int( Metrics::SizeGrip_Width ) );
+            extBottom = qMax( extBottom, int( Metrics::SizeGrip_Width ) );
+        }
+
         setResizeOnlyBorders(QMargins(extSides, 0, extSides, extBottom));
     }
 
@@ -458,7 +547,7 @@ namespace Inspire
     {
         m_leftButtons = new KDecoration2::DecorationButtonGroup(KDecoration2::DecorationButtonGroup::Position::Left, this, &Button::create);
         m_rightButtons = new KDecoration2::DecorationButtonGroup(KDecoration2::DecorationButtonGroup::Position::Right, this, &Button::create);
-        updateButtonsGeometry();
+        layoutButtons();
     }
 
     //________________________________________________________________
@@ -468,8 +557,16 @@ namespace Inspire
     //________________________________________________________________
     void Decoration::updateButtonsGeometry()
     {
-        const auto s = settings();
+        // buttons are created on first paint
+        if( !m_leftButtons ) return;
+
+        layoutButtons();
+        update();
+    }
 
+    //________________________________________________________________
+    void Decoration::layoutButtons()
+    {
         // adjust button position
         const int bHeight = captionHeight();
         const int verticalOffset = (captionHeight()-buttonHeight())/2;
@@ -505,8 +602,6 @@ namespace Inspire
 
         }
 
-        update();
-
     }
 
     // Classic alpha blending formula.
@@ -558,12 +653,18 @@ namespace Inspire
     //________________________________________________________________
     void Decoration::paint(QPainter *painter, const QRect &repaintRegion)
     {
-        // TODO: optimize based on repaintRegion
+        const Profiler::Scope profile( Profiler::DecorationPaint, profileId() );
+
+        // windows that are never shown, such as minimized ones or those on other desktops,
+        // do not pay for buttons and shadow
+        if( !m_initialized ) initDeferred();
+
         auto c = client().toStrongRef();
         auto s = settings();
 
-        // paint background
-        if( !c->isShaded() )
+        // paint background, unless only the title bar needs repainting
+        const QRect frameRect( hideTitleBar() ? rect() : QRect( 0, borderTop(), size().width(), size().height() - borderTop() ) );
+        if( !c->isShaded() && frameRect.intersects( repaintRegion ) )
         {
             painter->fillRect(rect(), Qt::transparent);
             painter->save();
@@ -574,6 +675,9 @@ namespace Inspire
             // clip away the top part
             if( !hideTitleBar() ) painter->setClipRect(0, borderTop(), size().width(), size().height() - borderTop(), Qt::IntersectClip);
 
+            // borderless windows stay borderless below, where only the size grip is painted
+            if( hasSizeGrip() ) painter->setClipRect(0, 0, size().width(), size().height() - borderBottom(), Qt::IntersectClip);
+
             if( s->isAlphaChannelSupported() ) painter->drawRoundedRect(rect(), m_scaledCornerRadius, m_scaledCornerRadius);
             else painter->drawRect( rect() );
 
@@ -582,7 +686,11 @@ namespace Inspire
 
         if( !hideTitleBar() ) paintTitleBar(painter, repaintRegion);
 
-        if( hasBorders() && !s->isAlphaChannelSupported() )
+        // size grip
+        if( hasSizeGrip() ) paintSizeGrip( painter, repaintRegion );
+
+        // outline, unless repaint region lies strictly inside
+        if( hasBorders() && !s->isAlphaChannelSupported() && !rect().adjusted( 1, 1, -1, -1 ).contains( repaintRegion ) )
         {
             painter->save();
             painter->setRenderHint(QPainter::Antialiasing, false);
@@ -595,11 +703,98 @@ namespace Inspire
             painter->restore();
         }
 
+        // repaint debugging
+        if( SettingsProvider::self()->showRepaints() ) paintRepaints( painter, repaintRegion );
+        else if( m_repaintCount > 0 )
+        {
+            m_repaints.clear();
+            m_repaintsFading = QRegion();
+            m_repaintCount = 0;
+            if( m_repaintsTimer ) m_repaintsTimer->stop();
+        }
+
+    }
+
+    //________________________________________________________________
+    void Decoration::paintRepaints( QPainter* painter, const QRect& repaintRegion )
+    {
+
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+        // record repainted region, unless it was only repainted to fade highlights out
+        if( !( QRegion( repaintRegion ) - m_repaintsFading ).isEmpty() )
+        {
+            m_repaints.append( { repaintRegion, now } );
+
+            // kwin may paint each part of the decoration separately. These count as a single repaint
+            if( !m_repaintCounted )
+            {
+                ++m_repaintCount;
+                m_repaintCounted = true;
+                QMetaObject::invokeMethod( this, [this]() { m_repaintCounted = false; }, Qt::QueuedConnection );
+            }
+        }
+
+        m_repaintsFading -= repaintRegion;
+
+        painter->save();
+        painter->setRenderHint( QPainter::Antialiasing, false );
+
+        // recent repaints are red, and turn yellow as they fade out. Overlapping repaints accumulate
+        for( const Repaint& repaint : qAsConst( m_repaints ) )
+        {
+            const qreal age = qBound( 0.0, qreal( now - repaint.time )/RepaintDecay, 1.0 );
+            painter->fillRect( repaint.rect, QColor::fromHsvF( age/6, 1.0, 1.0, 0.4*( 1.0 - age ) ) );
+        }
+
+        // repaint count
+        painter->setFont( settings()->font() );
+        painter->setPen( Qt::red );
+        painter->drawText( rect().adjusted( borderLeft() + 2, 0, 0, 0 ), Qt::AlignLeft|Qt::AlignTop|Qt::TextSingleLine, QString::number( m_repaintCount ) );
+
+        painter->restore();
+
+        // fade highlights out
+        if( !m_repaints.isEmpty() )
+        {
+            if( !m_repaintsTimer )
+            {
+                m_repaintsTimer = new QTimer( this );
+                m_repaintsTimer->setInterval( RepaintFadeInterval );
+                connect( m_repaintsTimer, &QTimer::timeout, this, &Decoration::fadeRepaints );
+            }
+
+            if( !m_repaintsTimer->isActive() ) m_repaintsTimer->start();
+        }
+
+    }
+
+    //________________________________________________________________
+    void Decoration::fadeRepaints()
+    {
+
+        // repaint all highlights, including the ones that just expired so that these get cleared
+        QRegion region;
+        for( const Repaint& repaint : qAsConst( m_repaints ) )
+        { region += repaint.rect; }
+
+        // drop expired highlights, and stop once all are gone
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        m_repaints.erase( std::remove_if( m_repaints.begin(), m_repaints.end(),
+            [now]( const Repaint& repaint ) { return now - repaint.time >= RepaintDecay; } ), m_repaints.end() );
+
+        if( m_repaints.isEmpty() ) m_repaintsTimer->stop();
+        if( region.isEmpty() ) return;
+
+        m_repaintsFading += region.boundingRect();
+        update( region.boundingRect() );
+
     }
 
     //________________________________________________________________
     void Decoration::paintTitleBar(QPainter *painter, const QRect &repaintRegion)
     {
+        const Profiler::Scope profile( Profiler::TitleBarPaint, profileId() );
         const auto c = client().toStrongRef();
         const QRect frontRect(QPoint(0, 0), QSize(size().width(), borderTop()));
         const QRect backRect(QPoint(0, 0), QSize(size().width(), borderTop()));
@@ -613,7 +808,7 @@ namespace Inspire
         painter->setPen(Qt::NoPen);
 
         // render a linear gradient on title area
-        if( c->isActive() && m_internalSettings->drawBackgroundGradient() )
+        if( c->isActive() && m_settings->drawBackgroundGradient() )
         {
 
             const QColor titleBarColor( this->titleBarColor() );
@@ -674,22 +869,30 @@ namespace Inspire
         painter->restore();
 
         // draw caption
-        painter->setFont(s->font());
-        painter->setPen( fontColor() );
         const auto cR = captionRect();
-        const QString caption = painter->fontMetrics().elidedText(c->caption(), Qt::ElideMiddle, cR.first.width());
-        painter->drawText(cR.first, cR.second | Qt::TextSingleLine, caption);
+        m_captionRect = cR.first;
+        if( cR.first.intersects( repaintRegion ) )
+        {
+            painter->setFont(s->font());
+            painter->setPen( fontColor() );
+            const QString caption = painter->fontMetrics().elidedText(c->caption(), Qt::ElideMiddle, cR.first.width());
+            painter->drawText(cR.first, cR.second | Qt::TextSingleLine, caption);
+        }
 
-        // draw all buttons
-        m_leftButtons->paint(painter, repaintRegion);
-        m_rightButtons->paint(painter, repaintRegion);
+        // draw buttons, each of them skips painting if outside of repaint region.
+        // They might not be created yet, if painting happens before the event loop runs
+        if( m_leftButtons )
+        {
+            m_leftButtons->paint(painter, repaintRegion);
+            m_rightButtons->paint(painter, repaintRegion);
+        }
     }
 
     //________________________________________________________________
     int Decoration::buttonHeight() const
     {
         const int baseSize = settings()->gridUnit();
-        switch( m_internalSettings->buttonSize() )
+        switch( m_settings->buttonSize() )
         {
             case InternalSettings::ButtonTiny: return baseSize;
             case InternalSettings::ButtonSmall: return baseSize*2;
@@ -711,19 +914,22 @@ namespace Inspire
         if( hideTitleBar() ) return qMakePair( QRect(), Qt::AlignCenter );
         else {
 
+            // buttons are created on first paint
             auto c = client().toStrongRef();
-            const int leftOffset = m_leftButtons->buttons().isEmpty() ?
+            const bool hasLeftButtons = m_leftButtons && !m_leftButtons->buttons().isEmpty();
+            const bool hasRightButtons = m_rightButtons && !m_rightButtons->buttons().isEmpty();
+            const int leftOffset = !hasLeftButtons ?
                 Metrics::TitleBar_SideMargin*settings()->smallSpacing():
                 m_leftButtons->geometry().x() + m_leftButtons->geometry().width() + Metrics::TitleBar_SideMargin*settings()->smallSpacing();
 
-            const int rightOffset = m_rightButtons->buttons().isEmpty() ?
+            const int rightOffset = !hasRightButtons ?
                 Metrics::TitleBar_SideMargin*settings()->smallSpacing() :
                 size().width() - m_rightButtons->geometry().x() + Metrics::TitleBar_SideMargin*settings()->smallSpacing();
 
             const int yOffset = 0;
             const QRect maxRect( leftOffset, yOffset, size().width() - leftOffset - rightOffset, captionHeight() );
 
-            switch( m_internalSettings->titleAlignment() )
+            switch( m_settings->titleAlignment() )
             {
                 case InternalSettings::AlignLeft:
                 return qMakePair( maxRect, Qt::AlignVCenter|Qt::AlignLeft );
@@ -762,38 +968,69 @@ namespace Inspire
     //________________________________________________________________
     void Decoration::updateShadow()
     {
-        auto s = settings();
+        // shadow is set up on first paint
+        if( !m_initialized ) return;
+
+        // maximized windows cover the whole screen, the shadow would not be visible
+        auto c = client().toStrongRef();
+        if( c->isMaximized() )
+        {
+            setShadow( QSharedPointer<KDecoration2::DecorationShadow>() );
+            return;
+        }
+
+        // shadow is not drawn past the screen edges the window is flush with
+        const Qt::Edges edges = shadowEdges();
+
         // Animated case, no cached shadow object
-        if ( (m_shadowAnimation->state() == QAbstractAnimation::Running) && (m_shadowOpacity != 0.0) && (m_shadowOpacity != 1.0) )
+        if ( m_shadowAnimation && (m_shadowAnimation->state() == QAbstractAnimation::Running) && (m_shadowOpacity != 0.0) && (m_shadowOpacity != 1.0) )
         {
-            setShadow(createShadowObject(0.5 + m_shadowOpacity * 0.5));
+            setShadow(createShadowObject(0.5 + m_shadowOpacity * 0.5, edges));
             return;
         }
 
-        if (g_shadowSizeEnum != m_internalSettings->shadowSize()
-                || g_shadowStrength != m_internalSettings->shadowStrength()
-                || g_shadowColor != m_internalSettings->shadowColor())
+        if (g_shadowSizeEnum != m_settings->shadowSize()
+                || g_shadowStrength != m_settings->shadowStrength()
+                || g_shadowColor != m_settings->shadowColor())
         {
-            g_sShadow.clear();
-            g_sShadowInactive.clear();
-            g_shadowSizeEnum = m_internalSettings->shadowSize();
-            g_shadowStrength = m_internalSettings->shadowStrength();
-            g_shadowColor = m_internalSettings->shadowColor();
+            g_sShadows.clear();
+            g_shadowSizeEnum = m_settings->shadowSize();
+            g_shadowStrength = m_settings->shadowStrength();
+            g_shadowColor = m_settings->shadowColor();
         }
 
-        auto c = client().toStrongRef();
-        auto& shadow = (c->isActive()) ? g_sShadow : g_sShadowInactive;
+        // there are at most 32 variants, each created when first needed
+        auto& shadow = g_sShadows[ shadowKey( c->isActive(), edges ) ];
         if ( !shadow )
         {
-            shadow = createShadowObject(c->isActive() ? 1.0 : 0.5);
+            shadow = createShadowObject(c->isActive() ? 1.0 : 0.5, edges);
         }
         setShadow(shadow);
     }
 
     //________________________________________________________________
-    QSharedPointer<KDecoration2::DecorationShadow> Decoration::createShadowObject( const float strengthScale )
+    int Decoration::shadowCacheSize()
+    { return g_sShadows.size(); }
+
+    //________________________________________________________________
+    Qt::Edges Decoration::shadowEdges() const
+    {
+        const auto c = client().toStrongRef();
+        Qt::Edges edges = c->adjacentScreenEdges();
+        if( c->isMaximizedHorizontally() ) edges |= Qt::LeftEdge|Qt::RightEdge;
+        if( c->isMaximizedVertically() ) edges |= Qt::TopEdge|Qt::BottomEdge;
+        return edges;
+    }
+
+    //________________________________________________________________
+    int Decoration::shadowKey( bool active, Qt::Edges edges )
+    { return int( edges ) << 1 | ( active ? 1 : 0 ); }
+
+    //________________________________________________________________
+    QSharedPointer<KDecoration2::DecorationShadow> Decoration::createShadowObject( const float strengthScale, Qt::Edges edges )
     {
-          const CompositeShadowParams params = lookupShadowParams(m_internalSettings->shadowSize());
+          const Profiler::Scope profile( Profiler::ShadowCreate, profileId() );
+          const CompositeShadowParams params = lookupShadowParams(m_settings->shadowSize());
           if (params.isNone())
           {
               return nullptr;
@@ -813,11 +1050,11 @@ namespace Inspire
           shadowRenderer.setBorderRadius(m_scaledCornerRadius + 0.5);
           shadowRenderer.setBoxSize(boxSize);
 
-          const qreal strength = m_internalSettings->shadowStrength() / 255.0 * strengthScale;
+          const qreal strength = m_settings->shadowStrength() / 255.0 * strengthScale;
           shadowRenderer.addShadow(params.shadow1.offset, params.shadow1.radius,
-              withOpacity(m_internalSettings->shadowColor(), params.shadow1.opacity * strength));
+              withOpacity(m_settings->shadowColor(), params.shadow1.opacity * strength));
           shadowRenderer.addShadow(params.shadow2.offset, params.shadow2.radius,
-              withOpacity(m_internalSettings->shadowColor(), params.shadow2.opacity * strength));
+              withOpacity(m_settings->shadowColor(), params.shadow2.opacity * strength));
 
           QImage shadowTexture = shadowRenderer.render();
 
@@ -830,7 +1067,7 @@ namespace Inspire
           boxRect.moveCenter(outerRect.center());
 
           // Mask out inner rect.
-          const QMargins padding = QMargins(
+          QMargins padding = QMargins(
               boxRect.left() - outerRect.left() - Metrics::Shadow_Overlap - params.offset.x(),
               boxRect.top() - outerRect.top() - Metrics::Shadow_Overlap - params.offset.y(),
               outerRect.right() - boxRect.right() - Metrics::Shadow_Overlap + params.offset.x(),
@@ -856,48 +1093,57 @@ namespace Inspire
 
           painter.end();
 
+          // trim the texture up to its center on given edges, so that nothing is composited there
+          const QPoint center = outerRect.center();
+          QRect textureRect = outerRect;
+          if( edges & Qt::LeftEdge ) { textureRect.setLeft( center.x() ); padding.setLeft( 0 ); }
+          if( edges & Qt::TopEdge ) { textureRect.setTop( center.y() ); padding.setTop( 0 ); }
+          if( edges & Qt::RightEdge ) { textureRect.setRight( center.x() ); padding.setRight( 0 ); }
+          if( edges & Qt::BottomEdge ) { textureRect.setBottom( center.y() ); padding.setBottom( 0 ); }
+
           auto ret = QSharedPointer<KDecoration2::DecorationShadow>::create();
           ret->setPadding(padding);
-          ret->setInnerShadowRect(QRect(outerRect.center(), QSize(1, 1)));
-          ret->setShadow(shadowTexture);
+          ret->setInnerShadowRect(QRect(center - textureRect.topLeft(), QSize(1, 1)));
+          ret->setShadow(textureRect == outerRect ? shadowTexture : shadowTexture.copy(textureRect));
           return ret;
     }
 
     //_________________________________________________________________
-    void Decoration::createSizeGrip()
+    bool Decoration::hasSizeGrip() const
     {
+        if( !( m_settings && m_settings->drawSizeGrip() && hasNoBorders() ) ) return false;
 
-        // do nothing if size grip already exist
-        if( m_sizeGrip ) return;
+        // without compositing, the strip around the grip would be painted opaque
+        if( !settings()->isAlphaChannelSupported() ) return false;
 
-        #if INSPIRE_HAVE_X11
-        if( !QX11Info::isPlatformX11() ) return;
+        // no room, nor use, for a grip when the window bottom is at the screen edge
+        const auto c = client().toStrongRef();
+        return c && c->isResizeable() && !c->isShaded() &&
+            !c->isMaximizedVertically() && !c->adjacentScreenEdges().testFlag( Qt::BottomEdge );
+    }
 
-        // access client
-        auto c = client().toStrongRef();
-        if( !c ) return;
+    //_________________________________________________________________
+    void Decoration::paintSizeGrip( QPainter* painter, const QRect& repaintRegion )
+    {
 
-        if( c->windowId() != 0 )
-        {
-            m_sizeGrip = new SizeGrip( this );
-            connect( c.data(), &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::updateSizeGripVisibility );
-            connect( c.data(), &KDecoration2::DecoratedClient::shadedChanged, this, &Decoration::updateSizeGripVisibility );
-            connect( c.data(), &KDecoration2::DecoratedClient::resizeableChanged, this, &Decoration::updateSizeGripVisibility );
-        }
-        #endif
+        // grip wedge, in bottom right corner, right below the window
+        const int gripSize = Metrics::SizeGrip_Width;
+        const QRect gripRect( size().width() - gripSize, size().height() - borderBottom(), gripSize, gripSize );
+        if( borderBottom() < gripSize || !gripRect.intersects( repaintRegion ) ) return;
+
+        painter->save();
+        painter->setRenderHint( QPainter::Antialiasing );
+        painter->setPen( Qt::NoPen );
+        painter->setBrush( titleBarColor() );
+        painter->drawPolygon( QVector<QPoint> {
+            gripRect.bottomLeft() + QPoint( 0, 1 ),
+            gripRect.topRight() + QPoint( 1, 0 ),
+            gripRect.bottomRight() + QPoint( 1, 1 ) } );
+        painter->restore();
 
     }
 
     //_________________________________________________________________
-    void Decoration::deleteSizeGrip()
-    {
-        if( m_sizeGrip )
-        {
-            m_sizeGrip->deleteLater();
-            m_sizeGrip = nullptr;
-        }
-    }
-    
     void Decoration::setScaledCornerRadius()
     {
         m_scaledCornerRadius = Metrics::Frame_FrameRadius;
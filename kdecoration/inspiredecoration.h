@@ -9,6 +9,7 @@
  */
 
 #include "inspire.h"
+#include "inspireeffectivesettings.h"
 #include "inspiresettings.h"
 
 #include <KDecoration2/Decoration>
@@ -16,9 +17,12 @@
 #include <KDecoration2/DecorationSettings>
 
 #include <QPalette>
+#include <QRegion>
 #include <QVariant>
 #include <QVariantAnimation>
+#include <QVector>
 
+class QTimer;
 class QVariantAnimation;
 
 namespace KDecoration2
@@ -29,7 +33,6 @@ namespace KDecoration2
 
 namespace Inspire
 {
-    class SizeGrip;
     class Decoration : public KDecoration2::Decoration
     {
         Q_OBJECT
@@ -47,12 +50,27 @@ namespace Inspire
 
         QColor borderColor() const;
 
-        //* internal settings
-        InternalSettingsPtr internalSettings() const
-        { return m_internalSettings; }
+        //* effective settings
+        EffectiveSettingsPtr effectiveSettings() const
+        { return m_settings; }
+
+        //* apply new settings, only updating what is flagged as changed
+        void applySettings( EffectiveSettingsPtr, SettingsChanges );
 
         qreal animationsDuration() const
-        { return m_animation->duration();}
+        { return m_animationDuration;}
+
+        //* window class, as "name class"
+        /** resolved once, and kept for the window's lifetime */
+        QString windowClass() const;
+
+        //* window id, used to tag profiling samples
+        /** only resolved when profiling is enabled, 0 otherwise */
+        quint64 profileId() const;
+
+        //* number of shadows in the cache shared by all decorations
+        /** it is emptied when the last decoration is destroyed */
+        static int shadowCacheSize();
 
         //* caption height
         int captionHeight() const;
@@ -99,17 +117,32 @@ namespace Inspire
         void updateButtonsGeometryDelayed();
         void updateTitleBar();
         void updateAnimationState();
-        void updateSizeGripVisibility();
 
         private:
 
         //* return the rect in which caption will be drawn
         QPair<QRect,Qt::Alignment> captionRect() const;
 
+        //* create buttons and shadow, deferred from init to first paint
+        void initDeferred();
+
+        //* create buttons
         void createButtons();
+
+        //* position buttons, without triggering repaint
+        void layoutButtons();
+
         void paintTitleBar(QPainter *painter, const QRect &repaintRegion);
         void updateShadow();
-        QSharedPointer<KDecoration2::DecorationShadow> createShadowObject( const float strengthScale );
+
+        //* create shadow, trimmed on given screen edges
+        QSharedPointer<KDecoration2::DecorationShadow> createShadowObject( const float strengthScale, Qt::Edges = Qt::Edges() );
+
+        //* screen edges the window is flush with
+        Qt::Edges shadowEdges() const;
+
+        //* shared shadow cache key
+        static int shadowKey( bool active, Qt::Edges );
         void setScaledCornerRadius();
         
         //*@name border size
@@ -122,22 +155,82 @@ namespace Inspire
 
         //*@name size grip
         //@{
-        void createSizeGrip();
-        void deleteSizeGrip();
-        SizeGrip* sizeGrip() const
-        { return m_sizeGrip; }
+
+        //* true if size grip is drawn. It is only drawn for resizable borderless windows, with compositing
+        bool hasSizeGrip() const;
+
+        //* paint size grip in bottom border
+        void paintSizeGrip( QPainter*, const QRect& );
+
+        //@}
+
+        //*@name repaint debugging
+        //@{
+
+        //* highlight recently repainted regions, and show repaint count
+        void paintRepaints( QPainter*, const QRect& );
+
+        //* repaint highlights so that these fade out, and drop expired ones
+        void fadeRepaints();
+
+        //* highlight fade out duration, and interval between fading steps, in milliseconds
+        enum
+        {
+            RepaintDecay = 1000,
+            RepaintFadeInterval = 50
+        };
+
+        //* repainted region, with its paint time
+        struct Repaint
+        {
+            QRect rect;
+            qint64 time;
+        };
+
+        //* recently repainted regions
+        QVector<Repaint> m_repaints;
+
+        //* number of repainted frames since highlighting was enabled
+        int m_repaintCount = 0;
+
+        //* true if current frame was already counted. Reset from the event loop
+        bool m_repaintCounted = false;
+
+        //* region repainted only to fade highlights out, that must not be recorded
+        QRegion m_repaintsFading;
+
+        //* fades highlights out, while there are any
+        QTimer *m_repaintsTimer = nullptr;
+
         //@}
 
-        InternalSettingsPtr m_internalSettings;
+        //* effective settings, shared with other windows using the same ones
+        EffectiveSettingsPtr m_settings;
+
         KDecoration2::DecorationButtonGroup *m_leftButtons = nullptr;
         KDecoration2::DecorationButtonGroup *m_rightButtons = nullptr;
 
-        //* size grip widget
-        SizeGrip *m_sizeGrip = nullptr;
+        //* true once buttons and shadow are created, on first paint
+        bool m_initialized = false;
+
+        //* last painted caption rect, used to restrict repaints on caption changes
+        QRect m_captionRect;
+
+        //*@name cached window class
+        //@{
+        mutable QString m_windowClass;
+        mutable bool m_windowClassResolved = false;
+        //@}
+
+        //* active state change animation, created when first needed
+        QVariantAnimation *m_animation = nullptr;
+        QVariantAnimation *m_shadowAnimation = nullptr;
 
-        //* active state change animation
-        QVariantAnimation *m_animation;
-        QVariantAnimation *m_shadowAnimation;
+        //*@name animation durations, in milliseconds
+        //@{
+        int m_animationDuration = 0;
+        int m_shadowAnimationDuration = 0;
+        //@}
 
         //* active state change opacity
         qreal m_opacity = 0;
@@ -150,57 +243,57 @@ namespace Inspire
 
     bool Decoration::hasBorders() const
     {
-        if( m_internalSettings && m_internalSettings->mask() & BorderSize ) return m_internalSettings->borderSize() > InternalSettings::BorderNoSides;
+        if( m_settings && m_settings->hasBorderSize() ) return m_settings->borderSize() > InternalSettings::BorderNoSides;
         else return settings()->borderSize() > KDecoration2::BorderSize::NoSides;
     }
 
     bool Decoration::hasNoBorders() const
     {
-        if( m_internalSettings && m_internalSettings->mask() & BorderSize ) return m_internalSettings->borderSize() == InternalSettings::BorderNone;
+        if( m_settings && m_settings->hasBorderSize() ) return m_settings->borderSize() == InternalSettings::BorderNone;
         else return settings()->borderSize() == KDecoration2::BorderSize::None;
     }
 
     bool Decoration::hasNoSideBorders() const
     {
-        if( m_internalSettings && m_internalSettings->mask() & BorderSize ) return m_internalSettings->borderSize() == InternalSettings::BorderNoSides;
+        if( m_settings && m_settings->hasBorderSize() ) return m_settings->borderSize() == InternalSettings::BorderNoSides;
         else return settings()->borderSize() == KDecoration2::BorderSize::NoSides;
     }
 
     bool Decoration::isMaximized() const
-    { return client().toStrongRef()->isMaximized() && !m_internalSettings->drawBorderOnMaximizedWindows(); }
+    { return client().toStrongRef()->isMaximized() && !m_settings->drawBorderOnMaximizedWindows(); }
 
     bool Decoration::isMaximizedHorizontally() const
-    { return client().toStrongRef()->isMaximizedHorizontally() && !m_internalSettings->drawBorderOnMaximizedWindows(); }
+    { return client().toStrongRef()->isMaximizedHorizontally() && !m_settings->drawBorderOnMaximizedWindows(); }
 
     bool Decoration::isMaximizedVertically() const
-    { return client().toStrongRef()->isMaximizedVertically() && !m_internalSettings->drawBorderOnMaximizedWindows(); }
+    { return client().toStrongRef()->isMaximizedVertically() && !m_settings->drawBorderOnMaximizedWindows(); }
 
     bool Decoration::isLeftEdge() const
     {
         const auto c = client().toStrongRef();
-        return (c->isMaximizedHorizontally() || c->adjacentScreenEdges().testFlag( Qt::LeftEdge ) ) && !m_internalSettings->drawBorderOnMaximizedWindows();
+        return (c->isMaximizedHorizontally() || c->adjacentScreenEdges().testFlag( Qt::LeftEdge ) ) && !m_settings->drawBorderOnMaximizedWindows();
     }
 
     bool Decoration::isRightEdge() const
     {
         const auto c = client().toStrongRef();
-        return (c->isMaximizedHorizontally() || c->adjacentScreenEdges().testFlag( Qt::RightEdge ) ) && !m_internalSettings->drawBorderOnMaximizedWindows();
+        return (c->isMaximizedHorizontally() || c->adjacentScreenEdges().testFlag( Qt::RightEdge ) ) && !m_settings->drawBorderOnMaximizedWindows();
     }
 
     bool Decoration::isTopEdge() const
     {
         const auto c = client().toStrongRef();
-        return (c->isMaximizedVertically() || c->adjacentScreenEdges().testFlag( Qt::TopEdge ) ) && !m_internalSettings->drawBorderOnMaximizedWindows();
+        return (c->isMaximizedVertically() || c->adjacentScreenEdges().testFlag( Qt::TopEdge ) ) && !m_settings->drawBorderOnMaximizedWindows();
     }
 
     bool Decoration::isBottomEdge() const
     {
         const auto c = client().toStrongRef();
-        return (c->isMaximizedVertically() || c->adjacentScreenEdges().testFlag( Qt::BottomEdge ) ) && !m_internalSettings->drawBorderOnMaximizedWindows();
+        return (c->isMaximizedVertically() || c->adjacentScreenEdges().testFlag( Qt::BottomEdge ) ) && !m_settings->drawBorderOnMaximizedWindows();
     }
 
     bool Decoration::hideTitleBar() const
-    { return m_internalSettings->hideTitleBar() && !client().toStrongRef()->isShaded(); }
+    { return m_settings->hideTitleBar() && !client().toStrongRef()->isShaded(); }
 
 }
 
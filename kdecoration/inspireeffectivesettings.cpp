@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "inspireeffectivesettings.h"
+
+namespace Inspire
+{
+
+    //__________________________________________________________________
+    EffectiveSettings EffectiveSettings::fromInternalSettings( const InternalSettings& internalSettings )
+    {
+
+        EffectiveSettings out;
+        out.m_borderSize = ( internalSettings.mask() & BorderSize ) ? internalSettings.borderSize() : -1;
+        out.m_titleAlignment = internalSettings.titleAlignment();
+        out.m_buttonSize = internalSettings.buttonSize();
+        out.m_shadowSize = internalSettings.shadowSize();
+        out.m_shadowStrength = qBound( 0, internalSettings.shadowStrength(), 255 );
+        out.m_shadowColor = internalSettings.shadowColor().rgba();
+
+        if( internalSettings.drawBorderOnMaximizedWindows() ) out.m_flags |= DrawBorderOnMaximizedWindows;
+        if( internalSettings.drawBackgroundGradient() ) out.m_flags |= DrawBackgroundGradient;
+        if( internalSettings.drawSizeGrip() ) out.m_flags |= DrawSizeGrip;
+        if( internalSettings.hideTitleBar() ) out.m_flags |= HideTitleBar;
+
+        out.updateHash();
+        return out;
+
+    }
+
+    //__________________________________________________________________
+    EffectiveSettings EffectiveSettings::overridden( bool hideTitleBar, int borderSize ) const
+    {
+
+        EffectiveSettings out( *this );
+        if( hideTitleBar ) out.m_flags |= HideTitleBar;
+        else out.m_flags &= quint8( ~HideTitleBar );
+
+        if( borderSize >= 0 ) out.m_borderSize = borderSize;
+
+        out.updateHash();
+        return out;
+
+    }
+
+    //__________________________________________________________________
+    void EffectiveSettings::updateHash()
+    {
+
+        // all fields but the color fit in 32 bits
+        const quint32 packed =
+            quint32( m_borderSize + 1 ) |
+            quint32( m_titleAlignment ) << 4 |
+            quint32( m_buttonSize ) << 8 |
+            quint32( m_shadowSize ) << 12 |
+            quint32( m_flags ) << 16 |
+            quint32( m_shadowStrength ) << 24;
+
+        m_hash = ::qHash( quint64( packed ) << 32 | m_shadowColor );
+
+    }
+
+    //__________________________________________________________________
+    SettingsChanges EffectiveSettings::changes( const EffectiveSettings& other ) const
+    {
+
+        if( *this == other ) return NoChange;
+
+        SettingsChanges changes;
+
+        // borders
+        if( m_borderSize != other.m_borderSize ||
+            m_buttonSize != other.m_buttonSize ||
+            ( m_flags & ( HideTitleBar|DrawBorderOnMaximizedWindows|DrawSizeGrip ) ) != ( other.m_flags & ( HideTitleBar|DrawBorderOnMaximizedWindows|DrawSizeGrip ) ) )
+        { changes |= BorderChange; }
+
+        // shadow
+        if( m_shadowSize != other.m_shadowSize ||
+            m_shadowStrength != other.m_shadowStrength ||
+            m_shadowColor != other.m_shadowColor )
+        { changes |= ShadowChange; }
+
+        // buttons
+        if( m_buttonSize != other.m_buttonSize )
+        { changes |= ButtonChange; }
+
+        // title bar
+        if( m_titleAlignment != other.m_titleAlignment ||
+            ( m_flags & ( HideTitleBar|DrawBorderOnMaximizedWindows|DrawBackgroundGradient ) ) != ( other.m_flags & ( HideTitleBar|DrawBorderOnMaximizedWindows|DrawBackgroundGradient ) ) )
+        { changes |= TitleBarChange; }
+
+        return changes;
+
+    }
+
+    //__________________________________________________________________
+    QDataStream& operator << ( QDataStream& stream, const EffectiveSettings& settings )
+    {
+        return stream
+            << settings.m_borderSize
+            << settings.m_titleAlignment
+            << settings.m_buttonSize
+            << settings.m_shadowSize
+            << settings.m_shadowStrength
+            << settings.m_flags
+            << quint32( settings.m_shadowColor );
+    }
+
+    //__________________________________________________________________
+    QDataStream& operator >> ( QDataStream& stream, EffectiveSettings& settings )
+    {
+
+        quint32 shadowColor = 0;
+        stream
+            >> settings.m_borderSize
+            >> settings.m_titleAlignment
+            >> settings.m_buttonSize
+            >> settings.m_shadowSize
+            >> settings.m_shadowStrength
+            >> settings.m_flags
+            >> shadowColor;
+
+        settings.m_shadowColor = shadowColor;
+        settings.updateHash();
+        return stream;
+
+    }
+
+}
@@ -0,0 +1,139 @@
+#ifndef inspireeffectivesettings_h
+#define inspireeffectivesettings_h
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "inspire.h"
+#include "inspiresettings.h"
+
+#include <QColor>
+#include <QDataStream>
+#include <QHash>
+#include <QSharedPointer>
+
+namespace Inspire
+{
+
+    //* compact, immutable copy of the settings used when rendering a window
+    /**
+    instances are interned by the settings provider, so that all windows
+    with identical settings share the same one
+    */
+    class EffectiveSettings
+    {
+
+        public:
+
+        //* create from configuration
+        static EffectiveSettings fromInternalSettings( const InternalSettings& );
+
+        //* copy with exception specific values. Negative border size keeps the current one
+        EffectiveSettings overridden( bool hideTitleBar, int borderSize ) const;
+
+        //*@name accessors
+        //@{
+
+        //* true if border size is forced by an exception, rather than following kwin's
+        bool hasBorderSize() const
+        { return m_borderSize >= 0; }
+
+        int borderSize() const
+        { return m_borderSize; }
+
+        int titleAlignment() const
+        { return m_titleAlignment; }
+
+        int buttonSize() const
+        { return m_buttonSize; }
+
+        int shadowSize() const
+        { return m_shadowSize; }
+
+        int shadowStrength() const
+        { return m_shadowStrength; }
+
+        QColor shadowColor() const
+        { return QColor::fromRgba( m_shadowColor ); }
+
+        bool drawBorderOnMaximizedWindows() const
+        { return m_flags & DrawBorderOnMaximizedWindows; }
+
+        bool drawBackgroundGradient() const
+        { return m_flags & DrawBackgroundGradient; }
+
+        bool drawSizeGrip() const
+        { return m_flags & DrawSizeGrip; }
+
+        bool hideTitleBar() const
+        { return m_flags & HideTitleBar; }
+
+        //* precomputed hash
+        uint hash() const
+        { return m_hash; }
+
+        //@}
+
+        //* changes needed to go from this settings to other
+        SettingsChanges changes( const EffectiveSettings& ) const;
+
+        //* equal to operator
+        bool operator == ( const EffectiveSettings& other ) const
+        {
+            return
+                m_hash == other.m_hash &&
+                m_shadowColor == other.m_shadowColor &&
+                m_borderSize == other.m_borderSize &&
+                m_titleAlignment == other.m_titleAlignment &&
+                m_buttonSize == other.m_buttonSize &&
+                m_shadowSize == other.m_shadowSize &&
+                m_shadowStrength == other.m_shadowStrength &&
+                m_flags == other.m_flags;
+        }
+
+        bool operator != ( const EffectiveSettings& other ) const
+        { return !( *this == other ); }
+
+        //*@name serialization, field by field. Hash is recomputed when reading
+        //@{
+        friend QDataStream& operator << ( QDataStream&, const EffectiveSettings& );
+        friend QDataStream& operator >> ( QDataStream&, EffectiveSettings& );
+        //@}
+
+        private:
+
+        //* update precomputed hash, after fields changed
+        void updateHash();
+
+        //* flags
+        enum Flag
+        {
+            DrawBorderOnMaximizedWindows = 1<<0,
+            DrawBackgroundGradient = 1<<1,
+            DrawSizeGrip = 1<<2,
+            HideTitleBar = 1<<3
+        };
+
+        QRgb m_shadowColor = 0;
+        uint m_hash = 0;
+        qint8 m_borderSize = -1;
+        quint8 m_titleAlignment = 0;
+        quint8 m_buttonSize = 0;
+        quint8 m_shadowSize = 0;
+        quint8 m_shadowStrength = 0;
+        quint8 m_flags = 0;
+
+    };
+
+    //* hash
+    inline uint qHash( const EffectiveSettings& settings, uint seed = 0 )
+    { return settings.hash() ^ seed; }
+
+    //* convenience typedef
+    using EffectiveSettingsPtr = QSharedPointer<const EffectiveSettings>;
+
+}
+
+#endif
@@ -10,66 +10,94 @@
 
 #include "inspireexceptionlist.h"
 
+#include <QStringList>
+#include <QVariant>
 
 namespace Inspire
 {
 
-    //______________________________________________________________
-    void ExceptionList::readConfig( KSharedConfig::Ptr config )
+    namespace
     {
 
-        _exceptions.clear();
+        //! enumeration choices, as named in inspiresettingsdata.kcfg
+        const QStringList& exceptionTypeChoices()
+        {
+            static const QStringList choices = { "ExceptionWindowClassName", "ExceptionWindowTitle" };
+            return choices;
+        }
 
-        QString groupName;
-        for( int index = 0; config->hasGroup( groupName = exceptionGroupName( index ) ); ++index )
+        const QStringList& borderSizeChoices()
         {
+            static const QStringList choices = {
+                "BorderNone", "BorderNoSides", "BorderTiny", "BorderNormal", "BorderLarge",
+                "BorderVeryLarge", "BorderHuge", "BorderVeryHuge", "BorderOversized" };
+            return choices;
+        }
 
-            // create exception
-            InternalSettings exception;
+        //! read enumeration, stored either as index or, like KConfigSkeleton does, as choice name
+        int readEnum( const KConfigGroup& group, const char* key, const QStringList& choices, int defaultValue )
+        {
 
-            // reset group
-            readConfig( &exception, config.data(), groupName );
+            if( !group.hasKey( key ) ) return defaultValue;
 
-            // create new configuration
-            InternalSettingsPtr configuration( new InternalSettings() );
-            configuration.data()->load();
+            const QString value( group.readEntry( key, QString() ) );
+            for( int index = 0; index < choices.size(); ++index )
+            { if( choices.at( index ).compare( value, Qt::CaseInsensitive ) == 0 ) return index; }
 
-            // apply changes from exception
-            configuration->setEnabled( exception.enabled() );
-            configuration->setExceptionType( exception.exceptionType() );
-            configuration->setExceptionPattern( exception.exceptionPattern() );
-            configuration->setMask( exception.mask() );
+            return group.readEntry( key, defaultValue );
 
-            // propagate all features found in mask to the output configuration
-            if( exception.mask() & BorderSize ) configuration->setBorderSize( exception.borderSize() );
-            configuration->setHideTitleBar( exception.hideTitleBar() );
+        }
 
-            // append to exceptions
-            _exceptions.append( configuration );
+        //! write entry unless stored value is already the same
+        bool writeEntry( KConfigGroup& group, const char* key, const QVariant& value )
+        {
+            if( group.hasKey( key ) && group.readEntry( key, QString() ) == value.toString() ) return false;
 
+            group.writeEntry( key, value );
+            return true;
         }
 
     }
 
     //______________________________________________________________
-    void ExceptionList::writeConfig( KSharedConfig::Ptr config )
+    void ExceptionList::readConfig( KSharedConfig::Ptr config )
     {
 
-        // remove all existing exceptions
+        _exceptions.clear();
+
         QString groupName;
         for( int index = 0; config->hasGroup( groupName = exceptionGroupName( index ) ); ++index )
-        { config->deleteGroup( groupName ); }
+        { _exceptions.append( readException( config->group( groupName ) ) ); }
+
+    }
 
-        // rewrite current exceptions
+    //______________________________________________________________
+    bool ExceptionList::writeConfig( KSharedConfig::Ptr config )
+    {
+
+        bool changed = false;
+
+        // update current exceptions, only writing what differs from stored values
         int index = 0;
-        foreach( const InternalSettingsPtr& exception, _exceptions )
+        foreach( const ExceptionSettingsPtr& exception, _exceptions )
         {
 
-            writeConfig( exception.data(), config.data(), exceptionGroupName( index ) );
+            KConfigGroup group( config->group( exceptionGroupName( index ) ) );
+            if( writeException( *exception, group ) ) changed = true;
             ++index;
 
         }
 
+        // remove exceptions left over from a longer list
+        QString groupName;
+        for( ; config->hasGroup( groupName = exceptionGroupName( index ) ); ++index )
+        {
+            config->deleteGroup( groupName );
+            changed = true;
+        }
+
+        return changed;
+
     }
 
     //_______________________________________________________________________
@@ -77,35 +105,38 @@ namespace Inspire
     { return QString( "Windeco Exception %1" ).arg( index ); }
 
     //______________________________________________________________
-    void ExceptionList::writeConfig( KCoreConfigSkeleton* skeleton, KConfig* config, const QString& groupName )
+    ExceptionSettingsPtr ExceptionList::readException( const KConfigGroup& group )
     {
 
-        // list of items to be written
-        QStringList keys = { "Enabled", "ExceptionPattern", "ExceptionType", "HideTitleBar", "Mask", "BorderSize"};
-
-        // write all items
-        foreach( auto key, keys )
-        {
-            KConfigSkeletonItem* item( skeleton->findItem( key ) );
-            if( !item ) continue;
+        ExceptionSettingsPtr exception( new ExceptionSettings() );
+        exception->setEnabled( group.readEntry( "Enabled", exception->enabled() ) );
+        exception->setExceptionPattern( group.readEntry( "ExceptionPattern", exception->exceptionPattern() ) );
+        exception->setExceptionType( readEnum( group, "ExceptionType", exceptionTypeChoices(), exception->exceptionType() ) );
+        exception->setHideTitleBar( group.readEntry( "HideTitleBar", exception->hideTitleBar() ) );
+        exception->setMask( group.readEntry( "Mask", exception->mask() ) );
 
-            if( !groupName.isEmpty() ) item->setGroup( groupName );
-            KConfigGroup configGroup( config, item->group() );
-            configGroup.writeEntry( item->key(), item->property() );
+        // border size is only relevant when set in mask
+        if( exception->mask() & BorderSize )
+        { exception->setBorderSize( readEnum( group, "BorderSize", borderSizeChoices(), exception->borderSize() ) ); }
 
-        }
+        return exception;
 
     }
 
     //______________________________________________________________
-    void ExceptionList::readConfig( KCoreConfigSkeleton* skeleton, KConfig* config, const QString& groupName )
+    bool ExceptionList::writeException( const ExceptionSettings& exception, KConfigGroup& group )
     {
 
-        foreach( KConfigSkeletonItem* item, skeleton->items() )
-        {
-            if( !groupName.isEmpty() ) item->setGroup( groupName );
-            item->readConfig( config );
-        }
+        // write items that differ from stored values
+        bool changed = false;
+        if( writeEntry( group, "Enabled", exception.enabled() ) ) changed = true;
+        if( writeEntry( group, "ExceptionPattern", exception.exceptionPattern() ) ) changed = true;
+        if( writeEntry( group, "ExceptionType", exception.exceptionType() ) ) changed = true;
+        if( writeEntry( group, "HideTitleBar", exception.hideTitleBar() ) ) changed = true;
+        if( writeEntry( group, "Mask", exception.mask() ) ) changed = true;
+        if( writeEntry( group, "BorderSize", exception.borderSize() ) ) changed = true;
+
+        return changed;
 
     }
 
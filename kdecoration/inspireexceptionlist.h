@@ -14,11 +14,89 @@
 #include "inspiresettings.h"
 #include "inspire.h"
 
+#include <KConfigGroup>
 #include <KSharedConfig>
 
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
 namespace Inspire
 {
 
+    //! window specific settings
+    /*!
+    only the rule and the values it may override are stored.
+    Other settings are taken from the base settings the exception is resolved against
+    */
+    class ExceptionSettings
+    {
+
+        public:
+
+        //!@name accessors
+        //@{
+
+        bool enabled() const
+        { return _enabled; }
+
+        int exceptionType() const
+        { return _exceptionType; }
+
+        const QString& exceptionPattern() const
+        { return _exceptionPattern; }
+
+        bool hideTitleBar() const
+        { return _hideTitleBar; }
+
+        //! overridden settings, as a combination of ExceptionMask
+        int mask() const
+        { return _mask; }
+
+        //! border size, only relevant if set in mask
+        int borderSize() const
+        { return _borderSize; }
+
+        //@}
+
+        //!@name modifiers
+        //@{
+
+        void setEnabled( bool value )
+        { _enabled = value; }
+
+        void setExceptionType( int value )
+        { _exceptionType = value; }
+
+        void setExceptionPattern( const QString& value )
+        { _exceptionPattern = value; }
+
+        void setHideTitleBar( bool value )
+        { _hideTitleBar = value; }
+
+        void setMask( int value )
+        { _mask = value; }
+
+        void setBorderSize( int value )
+        { _borderSize = value; }
+
+        //@}
+
+        private:
+
+        bool _enabled = true;
+        int _exceptionType = InternalSettings::ExceptionWindowClassName;
+        QString _exceptionPattern;
+        bool _hideTitleBar = false;
+        int _mask = None;
+        int _borderSize = InternalSettings::BorderNone;
+
+    };
+
+    //! convenience typedefs
+    using ExceptionSettingsPtr = QSharedPointer<ExceptionSettings>;
+    using ExceptionSettingsList = QList<ExceptionSettingsPtr>;
+
     //! inspire exceptions list
     class ExceptionList
     {
@@ -26,35 +104,36 @@ namespace Inspire
         public:
 
         //! constructor from list
-        explicit ExceptionList( const InternalSettingsList& exceptions = InternalSettingsList() ):
+        explicit ExceptionList( const ExceptionSettingsList& exceptions = ExceptionSettingsList() ):
             _exceptions( exceptions )
         {}
 
         //! exceptions
-        const InternalSettingsList& get( void ) const
+        const ExceptionSettingsList& get( void ) const
         { return _exceptions; }
 
         //! read from KConfig
         void readConfig( KSharedConfig::Ptr );
 
         //! write to kconfig
-        void writeConfig( KSharedConfig::Ptr );
+        /*! only changed, added or removed exceptions are written. Returns true if anything changed */
+        bool writeConfig( KSharedConfig::Ptr );
 
         protected:
 
         //! generate exception group name for given exception index
         static QString exceptionGroupName( int index );
 
-        //! read configuration
-        static void readConfig( KCoreConfigSkeleton*, KConfig*, const QString& );
+        //! read exception from group
+        static ExceptionSettingsPtr readException( const KConfigGroup& );
 
-        //! write configuration
-        static void writeConfig( KCoreConfigSkeleton*, KConfig*, const QString& );
+        //! write exception to group, skipping unchanged values. Returns true if anything changed
+        static bool writeException( const ExceptionSettings&, KConfigGroup& );
 
         private:
 
         //! exceptions
-        InternalSettingsList _exceptions;
+        ExceptionSettingsList _exceptions;
 
     };
 
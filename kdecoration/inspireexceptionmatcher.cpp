@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "inspireexceptionmatcher.h"
+#include "inspiresettings.h"
+
+namespace Inspire
+{
+
+    namespace
+    {
+        //* true if pattern contains no regular expression special character
+        bool isLiteral( QStringView pattern )
+        {
+            static const QString specialCharacters( QStringLiteral( "\\^$.|?*+()[]{}" ) );
+            for( const QChar& character : pattern )
+            { if( specialCharacters.contains( character ) ) return false; }
+
+            return true;
+        }
+    }
+
+    //__________________________________________________________________
+    const ExceptionMatcher::Rules& ExceptionMatcher::rules( int type ) const
+    { return type == InternalSettings::ExceptionWindowTitle ? m_titleRules : m_classNameRules; }
+
+    //__________________________________________________________________
+    ExceptionMatcher::Rules& ExceptionMatcher::rules( int type )
+    { return type == InternalSettings::ExceptionWindowTitle ? m_titleRules : m_classNameRules; }
+
+    //__________________________________________________________________
+    void ExceptionMatcher::addRule( int index, int type, const QString& pattern )
+    {
+
+        Rules& rules( this->rules( type ) );
+
+        // anchored literal, matches the whole value
+        if( pattern.size() >= 2 && pattern.startsWith( QLatin1Char( '^' ) ) && pattern.endsWith( QLatin1Char( '$' ) ) )
+        {
+            const QStringView literal( QStringView( pattern ).mid( 1, pattern.size() - 2 ) );
+            if( isLiteral( literal ) )
+            {
+                // first rule wins
+                const QString key( literal.toString() );
+                if( !rules.exact.contains( key ) ) rules.exact.insert( key, index );
+                return;
+            }
+        }
+
+        // plain literal, matches any substring
+        if( isLiteral( pattern ) )
+        {
+            rules.scan.append( { index, pattern, QRegularExpression() } );
+            return;
+        }
+
+        // regular expression
+        QRegularExpression regExp( pattern );
+        if( !regExp.isValid() ) return;
+
+        regExp.optimize();
+        rules.scan.append( { index, QString(), regExp } );
+
+    }
+
+    //__________________________________________________________________
+    int ExceptionMatcher::match( int type, const QString& value ) const
+    {
+
+        const Rules& rules( this->rules( type ) );
+
+        // exact matches. '$' also matches before a trailing newline
+        int result = rules.exact.value( value, -1 );
+        if( value.endsWith( QLatin1Char( '\n' ) ) )
+        {
+            const int index = rules.exact.value( value.chopped( 1 ), -1 );
+            if( index >= 0 && ( result < 0 || index < result ) ) result = index;
+        }
+
+        // scan remaining rules that have higher priority
+        for( const Rule& rule : rules.scan )
+        {
+            if( result >= 0 && rule.index > result ) break;
+
+            const bool matched( rule.literal.isEmpty() ?
+                rule.regExp.match( value ).hasMatch():
+                value.contains( rule.literal ) );
+
+            if( matched ) return rule.index;
+        }
+
+        return result;
+
+    }
+
+}
@@ -0,0 +1,88 @@
+#ifndef inspireexceptionmatcher_h
+#define inspireexceptionmatcher_h
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+namespace Inspire
+{
+
+    //* precompiled exception patterns
+    /**
+    anchored literal patterns are looked up in a hash,
+    plain literals use substring search and only the remaining patterns
+    go through the regular expression engine
+    */
+    class ExceptionMatcher
+    {
+
+        public:
+
+        //* add rule
+        /** rules must be added by increasing index, which is also their priority */
+        void addRule( int index, int type, const QString& pattern );
+
+        //* true if no rule has been added
+        bool isEmpty() const
+        { return !( hasRules( m_classNameRules ) || hasRules( m_titleRules ) ); }
+
+        //* true if at least one rule of given type has been added
+        bool hasRules( int type ) const
+        { return hasRules( rules( type ) ); }
+
+        //* index of the first rule of given type matching value, -1 if none
+        int match( int type, const QString& value ) const;
+
+        private:
+
+        //* rule that must be tested one by one
+        struct Rule
+        {
+            //* index
+            int index;
+
+            //* literal pattern, used when regular expression is not needed
+            QString literal;
+
+            //* compiled pattern
+            QRegularExpression regExp;
+        };
+
+        //* rules for a given exception type
+        struct Rules
+        {
+            //* anchored literal patterns, mapped to the lowest matching index
+            QHash<QString, int> exact;
+
+            //* remaining rules, ordered by index
+            QVector<Rule> scan;
+        };
+
+        //* rules for given type
+        const Rules& rules( int ) const;
+
+        //* rules for given type
+        Rules& rules( int );
+
+        //* true if rules are not empty
+        static bool hasRules( const Rules& rules )
+        { return !( rules.exact.isEmpty() && rules.scan.isEmpty() ); }
+
+        //* window class name rules
+        Rules m_classNameRules;
+
+        //* window title rules
+        Rules m_titleRules;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "inspiresettingscache.h"
+#include "config-inspire.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+namespace Inspire
+{
+
+    namespace
+    {
+        //* file magic, "INSP"
+        static constexpr quint32 s_magic = 0x494e5350;
+
+        //* format version, to be increased whenever the layout changes
+        static constexpr quint32 s_version = 2;
+
+        //* stream version
+        static constexpr int s_streamVersion = QDataStream::Qt_5_15;
+    }
+
+    //__________________________________________________________________
+    CompiledSettings CompiledSettings::compile( const InternalSettings& defaults, const ExceptionSettingsList& exceptions )
+    {
+
+        CompiledSettings out;
+        out.defaults = EffectiveSettings::fromInternalSettings( defaults );
+        out.exceptions.reserve( exceptions.size() );
+
+        for( int index = 0; index < exceptions.size(); ++index )
+        {
+
+            const ExceptionSettingsPtr& exception( exceptions.at( index ) );
+            out.exceptions.append( out.defaults.overridden( exception->hideTitleBar(), ( exception->mask() & BorderSize ) ? exception->borderSize() : -1 ) );
+
+            // discard disabled exceptions
+            if( !exception->enabled() ) continue;
+
+            // discard exceptions with empty exception pattern
+            if( exception->exceptionPattern().isEmpty() ) continue;
+
+            Rule rule;
+            rule.index = index;
+            rule.type = exception->exceptionType();
+            rule.pattern = exception->exceptionPattern();
+            out.rules.append( rule );
+
+        }
+
+        return out;
+
+    }
+
+    //__________________________________________________________________
+    QString SettingsCache::fileName()
+    { return QStandardPaths::writableLocation( QStandardPaths::GenericCacheLocation ) + QStringLiteral( "/inspire/inspirerc.cache" ); }
+
+    //__________________________________________________________________
+    QByteArray SettingsCache::stamp()
+    {
+
+        // plugin version and kcfg defaults, which apply to entries missing from inspirerc
+        QCryptographicHash hash( QCryptographicHash::Sha1 );
+        hash.addData( INSPIRE_PLUGIN_VERSION );
+        hash.addData( INSPIRE_SETTINGS_DEFAULTS_HASH );
+
+        // file contents rather than modification time and size, which can both be unchanged after an edit.
+        // System wide files are included, since these provide defaults
+        for( const QString& path : QStandardPaths::locateAll( QStandardPaths::GenericConfigLocation, QStringLiteral( "inspirerc" ) ) )
+        {
+            QFile file( path );
+            if( !file.open( QIODevice::ReadOnly ) ) continue;
+
+            hash.addData( path.toUtf8() );
+            hash.addData( &file );
+        }
+
+        return hash.result();
+
+    }
+
+    //__________________________________________________________________
+    bool SettingsCache::read( CompiledSettings& settings )
+    {
+
+        QFile file( fileName() );
+        if( !file.open( QIODevice::ReadOnly ) ) return false;
+
+        const qint64 size = file.size();
+        uchar* data = size > 0 ? file.map( 0, size ) : nullptr;
+        if( !data ) return false;
+
+        // no copy of the mapped data
+        const QByteArray bytes( QByteArray::fromRawData( reinterpret_cast<const char*>( data ), int( size ) ) );
+        QDataStream stream( bytes );
+        stream.setVersion( s_streamVersion );
+
+        bool valid = false;
+        CompiledSettings out;
+        do
+        {
+
+            // header
+            quint32 magic = 0;
+            quint32 version = 0;
+            stream >> magic >> version;
+            if( magic != s_magic || version != s_version ) break;
+
+            // stamp
+            QByteArray stored;
+            stream >> stored;
+            if( stream.status() != QDataStream::Ok || stored != stamp() ) break;
+
+            // defaults
+            stream >> out.defaults;
+
+            // exceptions. Each takes more than one byte, which bounds the count for corrupted files
+            quint32 count = 0;
+            stream >> count;
+            if( stream.status() != QDataStream::Ok || count > quint32( size ) ) break;
+
+            out.exceptions.resize( count );
+            for( EffectiveSettings& exception : out.exceptions )
+            { stream >> exception; }
+
+            if( stream.status() != QDataStream::Ok ) break;
+
+            // rules
+            stream >> count;
+            if( stream.status() != QDataStream::Ok || count > quint32( out.exceptions.size() ) ) break;
+
+            out.rules.resize( count );
+            for( CompiledSettings::Rule& rule : out.rules )
+            {
+                qint32 index = -1;
+                quint8 type = 0;
+                stream >> index >> type >> rule.pattern;
+                rule.index = index;
+                rule.type = type;
+            }
+
+            if( stream.status() != QDataStream::Ok ) break;
+
+            // check rule indices, which are used to access exceptions
+            valid = std::all_of( out.rules.cbegin(), out.rules.cend(), [&out]( const CompiledSettings::Rule& rule )
+                { return rule.index >= 0 && rule.index < out.exceptions.size(); } );
+
+        } while( false );
+
+        file.unmap( data );
+        if( valid ) settings = out;
+        return valid;
+
+    }
+
+    //__________________________________________________________________
+    bool SettingsCache::write( const CompiledSettings& settings )
+    {
+
+        const QString fileName( SettingsCache::fileName() );
+        if( !QDir().mkpath( QFileInfo( fileName ).absolutePath() ) ) return false;
+
+        QSaveFile file( fileName );
+        if( !file.open( QIODevice::WriteOnly ) ) return false;
+
+        QDataStream stream( &file );
+        stream.setVersion( s_streamVersion );
+
+        // header
+        stream << s_magic << s_version;
+
+        // stamp
+        stream << stamp();
+
+        // defaults
+        stream << settings.defaults;
+
+        // exceptions
+        stream << quint32( settings.exceptions.size() );
+        for( const EffectiveSettings& exception : settings.exceptions )
+        { stream << exception; }
+
+        // rules
+        stream << quint32( settings.rules.size() );
+        for( const CompiledSettings::Rule& rule : settings.rules )
+        { stream << qint32( rule.index ) << quint8( rule.type ) << rule.pattern; }
+
+        return stream.status() == QDataStream::Ok && file.commit();
+
+    }
+
+}
@@ -0,0 +1,88 @@
+#ifndef inspiresettingscache_h
+#define inspiresettingscache_h
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "inspireeffectivesettings.h"
+#include "inspireexceptionlist.h"
+#include "inspiresettings.h"
+#include "inspire.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+namespace Inspire
+{
+
+    //* settings as used by the settings provider: effective settings and exception rules
+    class CompiledSettings
+    {
+
+        public:
+
+        //* exception rule
+        struct Rule
+        {
+            //* exception index, also its priority
+            int index = -1;
+
+            //* exception type
+            int type = InternalSettings::ExceptionWindowClassName;
+
+            //* pattern
+            QString pattern;
+        };
+
+        //* compile from configuration
+        /**
+        exceptions are resolved against the default settings, overriding only the values they set.
+        Disabled exceptions and exceptions with empty pattern get no rule
+        */
+        static CompiledSettings compile( const InternalSettings&, const ExceptionSettingsList& );
+
+        //* default settings
+        EffectiveSettings defaults;
+
+        //* exception settings, by exception index
+        QVector<EffectiveSettings> exceptions;
+
+        //* exception rules, by increasing index
+        QVector<Rule> rules;
+
+    };
+
+    //* binary snapshot of compiled settings
+    /**
+    it is written next to the configuration, and memory mapped at startup
+    so that kwin does not need to go through KConfig to decorate its first windows.
+    The snapshot is only used when it matches a hash of the current inspirerc files contents,
+    the plugin version and the settings defaults.
+    */
+    class SettingsCache
+    {
+
+        public:
+
+        //* snapshot file
+        static QString fileName();
+
+        //* read snapshot. Returns false if missing, invalid or stale
+        static bool read( CompiledSettings& );
+
+        //* write snapshot, stamped with current inspirerc
+        static bool write( const CompiledSettings& );
+
+        private:
+
+        //* hash of plugin version, settings defaults and all inspirerc files, in lookup order
+        static QByteArray stamp();
+
+    };
+
+}
+
+#endif
@@ -7,111 +7,423 @@
 #include "inspiresettingsprovider.h"
 
 #include "inspireexceptionlist.h"
+#include "inspireprofiler.h"
+#include "inspiresettingscache.h"
 
-#include <KWindowInfo>
+#include <KConfigGroup>
+#include <KSharedConfig>
+#include <KWindowSystem>
 
-#include <QRegularExpression>
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QMutex>
 #include <QTextStream>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <algorithm>
 
 namespace Inspire
 {
 
-    SettingsProvider *SettingsProvider::s_self = nullptr;
+    QAtomicPointer<SettingsProvider> SettingsProvider::s_self;
+
+    namespace
+    {
+        //* singleton creation mutex
+        QBasicMutex s_selfMutex;
+
+        //* maximum time spent updating decorations in one event loop iteration, in milliseconds
+        const qint64 s_sliceDuration = 4;
+
+        //* delay between slices, in milliseconds. One frame at 60Hz
+        const int s_sliceInterval = 16;
+    }
 
     //__________________________________________________________________
-    SettingsProvider::SettingsProvider():
-        m_config( KSharedConfig::openConfig( QStringLiteral("inspirerc") ) )
-    { reconfigure(); }
+    SettingsProvider::SettingsProvider()
+    {
+
+        // use DBus connection to update on global settings change
+        // this is done once for all decorations
+        auto dbus = QDBusConnection::sessionBus();
+        dbus.connect( QString(),
+            QStringLiteral( "/KGlobalSettings" ),
+            QStringLiteral( "org.kde.KGlobalSettings" ),
+            QStringLiteral( "notifyChange" ), this, SLOT(reconfigure()) );
+
+        // repaint debugging
+        dbus.connect( QString(),
+            QStringLiteral( "/InspireDecoration" ),
+            QStringLiteral( "org.kde.Inspire.Debug" ),
+            QStringLiteral( "showRepaints" ), this, SLOT(setShowRepaints(bool)) );
+
+        // decorations on other desktops are updated when switching
+        connect( KWindowSystem::self(), &KWindowSystem::currentDesktopChanged, this, [this]() { undefer(); } );
+
+        // first snapshot is needed right away
+        std::atomic_store( &m_snapshot, load( SnapshotPtr() ) );
+
+    }
 
     //__________________________________________________________________
     SettingsProvider::~SettingsProvider()
-    { s_self = nullptr; }
+    { s_self.testAndSetOrdered( this, nullptr ); }
 
     //__________________________________________________________________
     SettingsProvider *SettingsProvider::self()
     {
-        // TODO: this is not thread safe!
-        if (!s_self)
-        { s_self = new SettingsProvider(); }
 
-        return s_self;
+        SettingsProvider* out = s_self.loadAcquire();
+        if( out ) return out;
+
+        QMutexLocker locker( &s_selfMutex );
+        out = s_self.loadAcquire();
+        if( !out )
+        {
+            out = new SettingsProvider();
+            s_self.storeRelease( out );
+        }
+
+        return out;
+
     }
 
     //__________________________________________________________________
     void SettingsProvider::reconfigure()
     {
-        if( !m_defaultSettings )
+
+        const int generation = m_generation.fetchAndAddOrdered( 1 ) + 1;
+        const SnapshotPtr previous( snapshot() );
+
+        // the worker never touches the provider. The result is posted to the application,
+        // and handed to the provider from the main thread
+        QThreadPool::globalInstance()->start( [generation, previous]()
         {
-            m_defaultSettings = InternalSettingsPtr(new InternalSettings());
-            m_defaultSettings->setCurrentGroup( QStringLiteral("Windeco") );
-        }
 
-        m_defaultSettings->load();
+            const SnapshotPtr snapshot( load( previous ) );
 
-        ExceptionList exceptions;
-        exceptions.readConfig( m_config );
-        m_exceptions = exceptions.get();
+            // publish and notify, unless a more recent reconfiguration was requested meanwhile
+            QMetaObject::invokeMethod( qApp, [generation, snapshot]()
+            {
+                SettingsProvider* provider = s_self.loadAcquire();
+                if( provider && generation == provider->m_generation.loadAcquire() )
+                { provider->apply( snapshot ); }
+            }, Qt::QueuedConnection );
+
+        } );
 
     }
 
     //__________________________________________________________________
-    InternalSettingsPtr SettingsProvider::internalSettings( Decoration *decoration ) const
+    SettingsProvider::SnapshotPtr SettingsProvider::load( const SnapshotPtr& previous )
     {
 
-        QString windowTitle;
-        QString className;
+        // use the compiled settings snapshot when up to date, and only parse configuration otherwise
+        CompiledSettings settings;
+        if( !SettingsCache::read( settings ) )
+        {
 
-        // get the client
-        const auto client = decoration->client().toStrongRef();
+            // shared configs are per thread, so that this does not interfere with the main thread
+            InternalSettings defaults;
+            defaults.load();
+
+            ExceptionList exceptions;
+            exceptions.readConfig( KSharedConfig::openConfig( QStringLiteral("inspirerc") ) );
+
+            settings = CompiledSettings::compile( defaults, exceptions.get() );
+            SettingsCache::write( settings );
+
+        }
+
+        auto out = std::make_shared<Snapshot>();
 
-        foreach( auto internalSettings, m_exceptions )
+        // intern effective settings, reusing unchanged entries so that decorations can compare pointers
+        auto intern = [&out, &previous]( const EffectiveSettings& settings )
         {
+            auto iter = out->effectiveSettings.constFind( settings );
+            if( iter != out->effectiveSettings.constEnd() ) return iter.value();
 
-            // discard disabled exceptions
-            if( !internalSettings->enabled() ) continue;
+            EffectiveSettingsPtr shared( previous ? previous->effectiveSettings.value( settings ) : EffectiveSettingsPtr() );
+            if( !shared ) shared = EffectiveSettingsPtr( new EffectiveSettings( settings ) );
 
-            // discard exceptions with empty exception pattern
-            if( internalSettings->exceptionPattern().isEmpty() ) continue;
+            out->effectiveSettings.insert( settings, shared );
+            return shared;
+        };
+
+        out->defaultSettings = intern( settings.defaults );
+
+        out->exceptionSettings.reserve( settings.exceptions.size() );
+        for( const EffectiveSettings& exception : qAsConst( settings.exceptions ) )
+        { out->exceptionSettings.append( intern( exception ) ); }
+
+        // compile exception patterns once
+        for( const CompiledSettings::Rule& rule : qAsConst( settings.rules ) )
+        { out->exceptionMatcher.addRule( rule.index, rule.type, rule.pattern ); }
+
+        // animations
+        const KConfigGroup cg( KSharedConfig::openConfig(), QStringLiteral("KDE") );
+        out->animationDurationFactor = cg.readEntry( "AnimationDurationFactor", 1.0f );
+
+        return out;
+
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::apply( const SnapshotPtr& snapshot )
+    {
 
-            /*
-            decide which value is to be compared
-            to the regular expression, based on exception type
-            */
-            QString value;
-            switch( internalSettings->exceptionType() )
+        const SnapshotPtr previous( std::atomic_exchange( &m_snapshot, snapshot ) );
+        m_classMatches.clear();
+        m_titleMatches.clear();
+
+        const bool animationChanged( !previous || previous->animationDurationFactor != snapshot->animationDurationFactor );
+        const SettingsChanges changes( animationChanged ? AnimationChange : NoChange );
+
+        // deferred decorations are kept deferred, with the new changes merged
+        for( PendingUpdate& update : m_deferred )
+        { update.changes |= changes; }
+
+        for( Decoration* decoration : qAsConst( m_decorations ) )
+        {
+            const bool deferred( std::any_of( m_deferred.cbegin(), m_deferred.cend(),
+                [decoration]( const PendingUpdate& update ) { return update.decoration == decoration; } ) );
+            if( !deferred ) addPending( m_pending, decoration, changes );
+        }
+
+        // active window first
+        std::stable_partition( m_pending.begin(), m_pending.end(),
+            []( const PendingUpdate& update )
             {
-                case InternalSettings::ExceptionWindowTitle:
-                {
-                    value = windowTitle.isEmpty() ? (windowTitle = client->caption()):windowTitle;
-                    break;
-                }
-
-                default:
-                case InternalSettings::ExceptionWindowClassName:
-                {
-                    if( className.isEmpty() )
-                    {
-                        // retrieve class name
-                        KWindowInfo info( client->windowId(), {}, NET::WM2WindowClass );
-                        QString window_className( QString::fromUtf8(info.windowClassName()) );
-                        QString window_class( QString::fromUtf8(info.windowClassClass()) );
-                        className = window_className + QStringLiteral(" ") + window_class;
-                    }
-
-                    value = className;
-                    break;
-                }
-
-            }
-
-            // check matching
-            QRegularExpression rx( internalSettings->exceptionPattern() );
-            if( rx.match( value ).hasMatch() )
-            { return internalSettings; }
+                const auto client = update.decoration->client().toStrongRef();
+                return client && client->isActive();
+            } );
+
+        processPending();
+
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::addPending( QVector<PendingUpdate>& updates, Decoration* decoration, SettingsChanges changes )
+    {
+
+        auto iter = std::find_if( updates.begin(), updates.end(),
+            [decoration]( const PendingUpdate& update ) { return update.decoration == decoration; } );
+
+        if( iter != updates.end() ) iter->changes |= changes;
+        else updates.append( { decoration, changes } );
+
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::processPending()
+    {
+
+        m_pendingScheduled = false;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        // the first decoration is always updated, so that the active window does not wait
+        int count = 0;
+        for( ; count < m_pending.size() && ( count == 0 || timer.elapsed() < s_sliceDuration ); ++count )
+        {
+            const PendingUpdate& update( m_pending.at( count ) );
+            if( isHidden( update.decoration ) ) addPending( m_deferred, update.decoration, update.changes );
+            else updateDecoration( update.decoration, update.changes );
+        }
+
+        m_pending.remove( 0, count );
+        if( !m_pending.isEmpty() ) schedulePending();
+
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::schedulePending()
+    {
+
+        if( m_pendingScheduled ) return;
+        m_pendingScheduled = true;
+
+        // a zero timer would only yield to the event loop, without any guarantee that the compositor
+        // gets to paint. Waiting for about a frame leaves it room to do so in between slices
+        QTimer::singleShot( s_sliceInterval, this, &SettingsProvider::processPending );
+
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::undefer( Decoration* decoration )
+    {
+
+        auto iter = std::stable_partition( m_deferred.begin(), m_deferred.end(),
+            [decoration]( const PendingUpdate& update ) { return decoration && update.decoration != decoration; } );
+        if( iter == m_deferred.end() ) return;
+
+        for( auto pending = iter; pending != m_deferred.end(); ++pending )
+        { addPending( m_pending, pending->decoration, pending->changes ); }
+
+        m_deferred.erase( iter, m_deferred.end() );
+        schedulePending();
 
+    }
+
+    //__________________________________________________________________
+    bool SettingsProvider::isHidden( Decoration* decoration )
+    {
+
+        // the current desktop is only reliably known from within kwin on X11.
+        // Elsewhere, updates are never deferred
+        if( !KWindowSystem::isPlatformX11() ) return false;
+
+        const auto client = decoration->client().toStrongRef();
+        if( !client || client->isOnAllDesktops() ) return false;
+
+        const int desktop = client->desktop();
+        return desktop > 0 && desktop != KWindowSystem::currentDesktop();
+
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::updateDecoration( Decoration* decoration, SettingsChanges changes )
+    {
+
+        // only notify decorations whose effective settings changed
+        const SnapshotPtr snapshot( this->snapshot() );
+        const int index = exceptionIndex( *snapshot, decoration );
+        const EffectiveSettingsPtr settings( index >= 0 ? snapshot->exceptionSettings.at( index ) : snapshot->defaultSettings );
+
+        decoration->applySettings( settings, changes | this->changes( decoration->effectiveSettings(), settings ) );
+
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::updateCaption( Decoration* decoration )
+    {
+
+        const SnapshotPtr snapshot( this->snapshot() );
+        const ExceptionMatcher& matcher( snapshot->exceptionMatcher );
+
+        // nothing to do unless some exceptions depend on the title
+        if( !matcher.hasRules( InternalSettings::ExceptionWindowTitle ) ) return;
+
+        int index = cachedMatch( *snapshot, InternalSettings::ExceptionWindowClassName, decoration->windowClass() );
+
+        const auto client = decoration->client().toStrongRef();
+        const int titleIndex = cachedMatch( *snapshot, InternalSettings::ExceptionWindowTitle, client->caption() );
+        if( titleIndex >= 0 && ( index < 0 || titleIndex < index ) ) index = titleIndex;
+
+        // interned settings are shared, so this is a no-op unless the matched exception changes the settings
+        const EffectiveSettingsPtr settings( index >= 0 ? snapshot->exceptionSettings.at( index ) : snapshot->defaultSettings );
+        decoration->applySettings( settings, changes( decoration->effectiveSettings(), settings ) );
+
+    }
+
+    //__________________________________________________________________
+    int SettingsProvider::cachedMatch( const Snapshot& snapshot, int type, const QString& value ) const
+    {
+
+        const ExceptionMatcher& matcher( snapshot.exceptionMatcher );
+        if( !matcher.hasRules( type ) ) return -1;
+
+        QHash<QString, int>& matches( type == InternalSettings::ExceptionWindowTitle ? m_titleMatches : m_classMatches );
+        auto iter = matches.constFind( value );
+        if( iter != matches.constEnd() ) return iter.value();
+
+        // keep memory bounded for windows with ever changing titles
+        if( matches.size() >= 1024 ) matches.clear();
+
+        const int index = matcher.match( type, value );
+        matches.insert( value, index );
+        return index;
+
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::setShowRepaints( bool value )
+    {
+
+        if( m_showRepaints == value ) return;
+        m_showRepaints = value;
+
+        // repaint everything, to show or clear highlights
+        for( Decoration* decoration : qAsConst( m_decorations ) )
+        { decoration->update(); }
+
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::registerDecoration( Decoration* decoration )
+    {
+
+        if( m_decorations.contains( decoration ) ) return;
+        m_decorations.append( decoration );
+
+        // deferred updates are applied once the window becomes visible
+        const auto client = decoration->client().toStrongRef();
+        connect( client.data(), &KDecoration2::DecoratedClient::desktopChanged, decoration, [this, decoration]() { undefer( decoration ); } );
+        connect( client.data(), &KDecoration2::DecoratedClient::onAllDesktopsChanged, decoration, [this, decoration]() { undefer( decoration ); } );
+
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::unregisterDecoration( Decoration* decoration )
+    {
+
+        m_decorations.removeOne( decoration );
+
+        auto matches = [decoration]( const PendingUpdate& update ) { return update.decoration == decoration; };
+        m_pending.erase( std::remove_if( m_pending.begin(), m_pending.end(), matches ), m_pending.end() );
+        m_deferred.erase( std::remove_if( m_deferred.begin(), m_deferred.end(), matches ), m_deferred.end() );
+
+    }
+
+    //__________________________________________________________________
+    SettingsChanges SettingsProvider::changes( const EffectiveSettingsPtr& first, const EffectiveSettingsPtr& second )
+    {
+
+        // interned settings are equal if and only if they are the same instance
+        if( first == second ) return NoChange;
+        if( !( first && second ) ) return AllChanges;
+        return first->changes( *second );
+
+    }
+
+    //__________________________________________________________________
+    EffectiveSettingsPtr SettingsProvider::effectiveSettings( Decoration *decoration ) const
+    {
+        const Profiler::Scope profile( Profiler::SettingsLookup, decoration->profileId() );
+        const SnapshotPtr snapshot( this->snapshot() );
+        const int index = exceptionIndex( *snapshot, decoration );
+        return index >= 0 ? snapshot->exceptionSettings.at( index ) : snapshot->defaultSettings;
+    }
+
+    //__________________________________________________________________
+    int SettingsProvider::exceptionIndex( const Snapshot& snapshot, Decoration *decoration )
+    {
+
+        const ExceptionMatcher& matcher( snapshot.exceptionMatcher );
+        if( matcher.isEmpty() ) return -1;
+
+        // get the client
+        const auto client = decoration->client().toStrongRef();
+
+        int index = -1;
+        if( matcher.hasRules( InternalSettings::ExceptionWindowClassName ) )
+        {
+            // class name is cached by the decoration
+            index = matcher.match( InternalSettings::ExceptionWindowClassName, decoration->windowClass() );
+        }
+
+        if( matcher.hasRules( InternalSettings::ExceptionWindowTitle ) )
+        {
+            // first matching exception wins, whatever its type
+            const int titleIndex = matcher.match( InternalSettings::ExceptionWindowTitle, client->caption() );
+            if( titleIndex >= 0 && ( index < 0 || titleIndex < index ) ) index = titleIndex;
         }
 
-        return m_defaultSettings;
+        return index;
 
     }
 
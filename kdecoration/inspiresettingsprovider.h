@@ -7,16 +7,32 @@
  */
 
 #include "inspiredecoration.h"
+#include "inspireeffectivesettings.h"
+#include "inspireexceptionmatcher.h"
 #include "inspiresettings.h"
 #include "inspire.h"
 
-#include <KSharedConfig>
-
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QHash>
 #include <QObject>
+#include <QVector>
+
+#include <memory>
 
 namespace Inspire
 {
 
+    //* settings provider
+    /**
+    configuration is parsed, and exception patterns compiled, on a worker thread.
+    The result is published as an immutable snapshot, that can be read from any thread.
+    It is swapped with the std::atomic_load/store functions for shared_ptr, which are not lock-free:
+    they take a short internal lock around the pointer copy, but readers never wait for parsing.
+    Decorations are notified of changes on the main thread, active window first, then visible
+    windows in time-boxed slices. On X11, windows on other desktops are only notified once
+    they become visible.
+    */
     class SettingsProvider: public QObject
     {
 
@@ -30,30 +46,141 @@ namespace Inspire
         //* singleton
         static SettingsProvider *self();
 
-        //* internal settings for given decoration
-        InternalSettingsPtr internalSettings(Decoration *) const;
+        //* effective settings for given decoration
+        EffectiveSettingsPtr effectiveSettings(Decoration *) const;
+
+        //* animation duration factor, from kdeglobals
+        qreal animationDurationFactor() const
+        { return snapshot()->animationDurationFactor; }
+
+        //*@name decorations notified on configuration changes
+        /** these must be called from the main thread */
+        //@{
+        void registerDecoration( Decoration* );
+        void unregisterDecoration( Decoration* );
+        //@}
+
+        //* re-evaluate title exceptions after given decoration's caption changed
+        /** decoration is only updated if the resulting settings change. Must be called from the main thread */
+        void updateCaption( Decoration* );
+
+        //* changes between two settings
+        static SettingsChanges changes( const EffectiveSettingsPtr&, const EffectiveSettingsPtr& );
+
+        //* true if repainted regions are highlighted, for debugging
+        bool showRepaints() const
+        { return m_showRepaints; }
 
         public Q_SLOTS:
 
         //* reconfigure
+        /** parsing happens asynchronously, decorations are updated once it is done */
         void reconfigure();
 
+        //* highlight repainted regions
+        /**
+        toggled from the org.kde.Inspire.Debug.showRepaints DBus signal, e.g.
+        dbus-send --session --type=signal /InspireDecoration org.kde.Inspire.Debug.showRepaints boolean:true
+        */
+        void setShowRepaints( bool );
+
         private:
 
+        //* immutable settings snapshot
+        struct Snapshot
+        {
+            //* default settings
+            EffectiveSettingsPtr defaultSettings;
+
+            //* exception settings, by exception index
+            QVector<EffectiveSettingsPtr> exceptionSettings;
+
+            //* interned effective settings
+            QHash<EffectiveSettings, EffectiveSettingsPtr> effectiveSettings;
+
+            //* compiled exception patterns
+            ExceptionMatcher exceptionMatcher;
+
+            //* animation duration factor
+            qreal animationDurationFactor = 1.0;
+        };
+
+        using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
         //* constructor
         SettingsProvider();
 
-        //* default configuration
-        InternalSettingsPtr m_defaultSettings;
+        //* current snapshot. Only the pointer copy is guarded, by the standard library
+        SnapshotPtr snapshot() const
+        { return std::atomic_load( &m_snapshot ); }
+
+        //* load new snapshot. Effective settings that are unchanged from previous are reused
+        /** this does not access any member, and can be run from any thread */
+        static SnapshotPtr load( const SnapshotPtr& previous );
+
+        //* publish new snapshot and schedule decorations update. Must be called from the main thread
+        void apply( const SnapshotPtr& );
+
+        //* decoration waiting for new settings, with changes that cannot be deduced from settings
+        struct PendingUpdate
+        {
+            Decoration* decoration;
+            SettingsChanges changes;
+        };
+
+        //* add decoration to pending updates, merging changes if already there
+        static void addPending( QVector<PendingUpdate>&, Decoration*, SettingsChanges );
+
+        //* update pending decorations until time slice is exhausted, and reschedule if needed
+        void processPending();
+
+        //* schedule pending updates processing
+        void schedulePending();
+
+        //* move deferred updates back to pending, for given decoration, or all if null
+        void undefer( Decoration* = nullptr );
+
+        //* true if decoration is known not to be on current desktop. Always false unless on X11
+        static bool isHidden( Decoration* );
+
+        //* apply current settings to decoration
+        void updateDecoration( Decoration*, SettingsChanges );
+
+        //* index of the exception matching given decoration, -1 if none
+        static int exceptionIndex( const Snapshot&, Decoration* );
+
+        //* current snapshot
+        SnapshotPtr m_snapshot;
+
+        //* reconfiguration generation, to discard outdated results
+        QAtomicInt m_generation;
+
+        //* memoized match for given exception type and value, with current snapshot
+        int cachedMatch( const Snapshot&, int type, const QString& value ) const;
+
+        //* registered decorations
+        QVector<Decoration*> m_decorations;
+
+        //* decorations to be updated, in order
+        QVector<PendingUpdate> m_pending;
+
+        //* decorations to be updated once visible
+        QVector<PendingUpdate> m_deferred;
+
+        //* true if pending updates processing is scheduled
+        bool m_pendingScheduled = false;
 
-        //* exceptions
-        InternalSettingsList m_exceptions;
+        //* highlight repainted regions
+        bool m_showRepaints = false;
 
-        //* config object
-        KSharedConfigPtr m_config;
+        //*@name memoized exception matches, by window class and caption. Reset with snapshot
+        //@{
+        mutable QHash<QString, int> m_classMatches;
+        mutable QHash<QString, int> m_titleMatches;
+        //@}
 
         //* singleton
-        static SettingsProvider *s_self;
+        static QAtomicPointer<SettingsProvider> s_self;
 
     };
 
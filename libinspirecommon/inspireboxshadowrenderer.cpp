@@ -17,6 +17,7 @@
 
 // own
 #include "inspireboxshadowrenderer.h"
+#include "inspireprofiler.h"
 
 // Qt
 #include <QPainter>
@@ -209,6 +210,166 @@ static inline void boxBlurAlpha(QImage &image, int radius, const QRect &rect = {
     }
 }
 
+/**
+ * Coefficients of the Young - van Vliet recursive Gaussian filter.
+ *
+ * See I.T. Young, L.J. van Vliet, "Recursive implementation of the Gaussian filter",
+ * Signal Processing 44 (1995) 139-151. Feedback coefficients are normalized by b0.
+ **/
+struct RecursiveGaussianCoefficients
+{
+    explicit RecursiveGaussianCoefficients(qreal sigma)
+    {
+        const qreal q = sigma >= 2.5
+            ? 0.98711 * sigma - 0.96330
+            : 3.97156 - 4.14554 * qSqrt(1.0 - 0.26891 * sigma);
+
+        const qreal q2 = q * q;
+        const qreal q3 = q2 * q;
+
+        const qreal b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+        a1 = (2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0;
+        a2 = -(1.4281 * q2 + 1.26661 * q3) / b0;
+        a3 = (0.422205 * q3) / b0;
+        gain = 1.0 - (a1 + a2 + a3);
+    }
+
+    float gain;
+    float a1;
+    float a2;
+    float a3;
+};
+
+/**
+ * Process a row with the recursive Gaussian filter, in place.
+ *
+ * Values past both ends of the row are taken equal to the first and last
+ * values, like the box filter does.
+ *
+ * @param row The row.
+ * @param width The width of the row, in pixels.
+ * @param c The filter coefficients.
+ **/
+static inline void recursiveGaussianRow(float *row, int width, const RecursiveGaussianCoefficients &c)
+{
+    // causal pass
+    float w1 = row[0];
+    float w2 = w1;
+    float w3 = w1;
+    for (int i = 0; i < width; ++i) {
+        const float w = c.gain * row[i] + c.a1 * w1 + c.a2 * w2 + c.a3 * w3;
+        row[i] = w;
+        w3 = w2;
+        w2 = w1;
+        w1 = w;
+    }
+
+    // anti-causal pass
+    float y1 = row[width - 1];
+    float y2 = y1;
+    float y3 = y1;
+    for (int i = width - 1; i >= 0; --i) {
+        const float y = c.gain * row[i] + c.a1 * y1 + c.a2 * y2 + c.a3 * y3;
+        row[i] = y;
+        y3 = y2;
+        y2 = y1;
+        y1 = y;
+    }
+}
+
+/**
+ * Process all columns with the recursive Gaussian filter, in place.
+ *
+ * Columns are processed together, one row at a time, so that memory is accessed
+ * sequentially and the inner loops can be vectorized by the compiler.
+ *
+ * @param data The rows.
+ * @param width The width of the rows, in pixels.
+ * @param height The number of rows.
+ * @param c The filter coefficients.
+ **/
+static inline void recursiveGaussianColumns(float *data, int width, int height, const RecursiveGaussianCoefficients &c)
+{
+    // values past both ends of the columns
+    QVector<float> edge(data, data + width);
+
+    // causal pass
+    for (int j = 0; j < height; ++j) {
+        float *row = data + j * width;
+        const float *w1 = j >= 1 ? row - width : edge.constData();
+        const float *w2 = j >= 2 ? row - 2 * width : edge.constData();
+        const float *w3 = j >= 3 ? row - 3 * width : edge.constData();
+        for (int i = 0; i < width; ++i) {
+            row[i] = c.gain * row[i] + c.a1 * w1[i] + c.a2 * w2[i] + c.a3 * w3[i];
+        }
+    }
+
+    // anti-causal pass
+    const float *last = data + (height - 1) * width;
+    edge = QVector<float>(last, last + width);
+    for (int j = height - 1; j >= 0; --j) {
+        float *row = data + j * width;
+        const float *y1 = j + 1 < height ? row + width : edge.constData();
+        const float *y2 = j + 2 < height ? row + 2 * width : edge.constData();
+        const float *y3 = j + 3 < height ? row + 3 * width : edge.constData();
+        for (int i = 0; i < width; ++i) {
+            row[i] = c.gain * row[i] + c.a1 * y1[i] + c.a2 * y2[i] + c.a3 * y3[i];
+        }
+    }
+}
+
+/**
+ * Blur the alpha channel of a given image with a recursive Gaussian filter.
+ *
+ * Unlike boxBlurAlpha, the cost per pixel does not depend on the radius.
+ *
+ * @param image The input image.
+ * @param radius The blur radius.
+ * @param rect Specifies what part of the image to blur. If nothing is provided, then
+ *    the whole alpha channel of the input image will be blurred.
+ **/
+static inline void recursiveGaussianBlurAlpha(QImage &image, int radius, const QRect &rect = {})
+{
+    if (radius < 2) {
+        return;
+    }
+
+    const RecursiveGaussianCoefficients coefficients(calculateBlurStdDev(radius));
+
+    const QRect blurRect = rect.isNull() ? image.rect() : rect;
+
+    const int alphaOffset = QSysInfo::ByteOrder == QSysInfo::BigEndian ? 0 : 3;
+    const int width = blurRect.width();
+    const int height = blurRect.height();
+    const int pixelStride = image.depth() >> 3;
+
+    // the recursion needs more precision than 8 bits
+    QVector<float> data(width * height);
+    for (int j = 0; j < height; ++j) {
+        const uint8_t *in = image.constScanLine(blurRect.y() + j) + blurRect.x() * pixelStride + alphaOffset;
+        float *out = data.data() + j * width;
+        for (int i = 0; i < width; ++i, in += pixelStride) {
+            out[i] = *in;
+        }
+    }
+
+    // Blur the image in horizontal direction.
+    for (int j = 0; j < height; ++j) {
+        recursiveGaussianRow(data.data() + j * width, width, coefficients);
+    }
+
+    // Blur the image in vertical direction.
+    recursiveGaussianColumns(data.data(), width, height, coefficients);
+
+    for (int j = 0; j < height; ++j) {
+        const float *in = data.constData() + j * width;
+        uint8_t *out = image.scanLine(blurRect.y() + j) + blurRect.x() * pixelStride + alphaOffset;
+        for (int i = 0; i < width; ++i, out += pixelStride) {
+            *out = uint8_t(qBound(0.0f, in[i] + 0.5f, 255.0f));
+        }
+    }
+}
+
 static inline void mirrorTopLeftQuadrant(QImage &image)
 {
     const int width = image.width();
@@ -239,7 +400,8 @@ static inline void mirrorTopLeftQuadrant(QImage &image)
     }
 }
 
-static void renderShadow(QPainter *painter, const QRect &rect, qreal borderRadius, const QPoint &offset, int radius, const QColor &color)
+static void renderShadow(QPainter *painter, const QRect &rect, qreal borderRadius, const QPoint &offset, int radius, const QColor &color,
+                         BoxShadowRenderer::BlurMethod blurMethod)
 {
     const QSize inflation = calculateBlurExtent(radius);
     const QSize size = rect.size() + 2 * inflation;
@@ -268,7 +430,11 @@ static void renderShadow(QPainter *painter, const QRect &rect, qreal borderRadiu
     // only the top-left quadrant and then mirror it.
     const QRect blurRect(0, 0, qCeil(shadow.width() * 0.5), qCeil(shadow.height() * 0.5));
     const int scaledRadius = qRound(radius * dpr);
-    boxBlurAlpha(shadow, scaledRadius, blurRect);
+    if (blurMethod == BoxShadowRenderer::BlurMethod::RecursiveGaussian) {
+        recursiveGaussianBlurAlpha(shadow, scaledRadius, blurRect);
+    } else {
+        boxBlurAlpha(shadow, scaledRadius, blurRect);
+    }
     mirrorTopLeftQuadrant(shadow);
 
     // Give the shadow a tint of the desired color.
@@ -284,6 +450,19 @@ static void renderShadow(QPainter *painter, const QRect &rect, qreal borderRadiu
     painter->drawImage(shadowRect, shadow);
 }
 
+void BoxShadowRenderer::setBlurMethod(BlurMethod method)
+{
+    m_blurMethod = method;
+}
+
+BoxShadowRenderer::BlurMethod BoxShadowRenderer::defaultBlurMethod()
+{
+    static const BlurMethod method = qEnvironmentVariable("INSPIRE_SHADOW_BLUR") == QLatin1String("recursive")
+        ? BlurMethod::RecursiveGaussian
+        : BlurMethod::Box;
+    return method;
+}
+
 void BoxShadowRenderer::setBoxSize(const QSize &size)
 {
     m_boxSize = size;
@@ -305,6 +484,8 @@ void BoxShadowRenderer::addShadow(const QPoint &offset, int radius, const QColor
 
 QImage BoxShadowRenderer::render() const
 {
+    const Profiler::Scope profile(Profiler::ShadowRender);
+
     if (m_shadows.isEmpty()) {
         return {};
     }
@@ -323,7 +504,7 @@ QImage BoxShadowRenderer::render() const
 
     QPainter painter(&canvas);
     for (const Shadow &shadow : qAsConst(m_shadows)) {
-        renderShadow(&painter, boxRect, m_borderRadius, shadow.offset, shadow.radius, shadow.color);
+        renderShadow(&painter, boxRect, m_borderRadius, shadow.offset, shadow.radius, shadow.color, m_blurMethod);
     }
     painter.end();
 
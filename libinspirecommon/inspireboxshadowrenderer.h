@@ -23,6 +23,30 @@ class INSPIRECOMMON_EXPORT BoxShadowRenderer
 public:
     // Compiler generated constructors & destructor are fine.
 
+    /**
+     * Blur implementation.
+     **/
+    enum class BlurMethod {
+        /// Three box filter passes, cost grows with the radius.
+        Box,
+        /// Young - van Vliet recursive Gaussian, constant cost per pixel.
+        RecursiveGaussian,
+    };
+
+    /**
+     * Set the blur implementation.
+     * @param method The blur implementation.
+     **/
+    void setBlurMethod(BlurMethod method);
+
+    /**
+     * Default blur implementation.
+     *
+     * This is Box, unless the INSPIRE_SHADOW_BLUR environment variable is set to
+     * "recursive", so that both can be compared on a running session.
+     **/
+    static BlurMethod defaultBlurMethod();
+
     /**
      * Set the size of the box.
      * @param size The size of the box.
@@ -73,6 +97,7 @@ public:
 private:
     QSize m_boxSize;
     qreal m_borderRadius = 0.0;
+    BlurMethod m_blurMethod = defaultBlurMethod();
 
     struct Shadow {
         QPoint offset;
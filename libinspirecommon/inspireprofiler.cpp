@@ -0,0 +1,239 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+// own
+#include "inspireprofiler.h"
+
+// Qt
+#include <QByteArray>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QVector>
+
+// std
+#include <algorithm>
+
+#include <unistd.h>
+
+namespace Inspire
+{
+
+namespace
+{
+
+struct Statistics {
+    qint64 count = 0;
+    qint64 total = 0;
+    qint64 minimum = 0;
+    qint64 maximum = 0;
+
+    // individual samples, for percentiles
+    QVector<qint64> samples;
+};
+
+struct ProfilerState {
+    ProfilerState()
+        : profiling(qEnvironmentVariableIsSet("INSPIRE_PROFILE"))
+        , interval(qEnvironmentVariableIntValue("INSPIRE_PROFILE"))
+    {
+        if (interval <= 0) {
+            interval = 500;
+        }
+
+        const QString traceFile = qEnvironmentVariable("INSPIRE_TRACE");
+        if (!traceFile.isEmpty()) {
+            trace.setFileName(traceFile);
+            tracing = trace.open(QIODevice::WriteOnly | QIODevice::Truncate);
+            if (tracing) {
+                // the closing bracket is optional in the trace event format,
+                // which keeps the file valid if kwin does not exit cleanly
+                trace.write("[\n");
+            } else {
+                qWarning() << "Inspire profiler: cannot open trace file" << traceFile;
+            }
+        }
+
+        timer.start();
+    }
+
+    ~ProfilerState()
+    {
+        flush();
+    }
+
+    void flush()
+    {
+        if (tracing && !traceBuffer.isEmpty()) {
+            trace.write(traceBuffer);
+            trace.flush();
+            traceBuffer.clear();
+        }
+    }
+
+    bool profiling;
+    bool tracing = false;
+    int interval;
+    Statistics statistics[Profiler::SectionCount];
+
+    QElapsedTimer timer;
+    QFile trace;
+    QByteArray traceBuffer;
+};
+
+ProfilerState &state()
+{
+    static ProfilerState s_state;
+    return s_state;
+}
+
+const char *sectionName(Profiler::Section section)
+{
+    switch (section) {
+    case Profiler::DecorationPaint:
+        return "Decoration::paint";
+    case Profiler::TitleBarPaint:
+        return "Decoration::paintTitleBar";
+    case Profiler::ButtonPaint:
+        return "Button::paint";
+    case Profiler::DecorationInit:
+        return "Decoration::init";
+    case Profiler::DecorationReconfigure:
+        return "Decoration::reconfigure";
+    case Profiler::RecalculateBorders:
+        return "Decoration::recalculateBorders";
+    case Profiler::SettingsLookup:
+        return "SettingsProvider::effectiveSettings";
+    case Profiler::ShadowCreate:
+        return "Decoration::createShadowObject";
+    case Profiler::ShadowRender:
+        return "BoxShadowRenderer::render";
+    default:
+        return "unknown";
+    }
+}
+
+qint64 percentile(QVector<qint64> &samples, int percent)
+{
+    // samples are only partially sorted, when reporting
+    const int index = qMin(samples.size() - 1, samples.size() * percent / 100);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples.at(index);
+}
+
+void addStatistics(ProfilerState &s, Profiler::Section section, qint64 nsecs)
+{
+    Statistics &statistics = s.statistics[section];
+
+    if (statistics.count == 0 || nsecs < statistics.minimum) {
+        statistics.minimum = nsecs;
+    }
+    statistics.maximum = qMax(statistics.maximum, nsecs);
+    statistics.total += nsecs;
+    statistics.samples.append(nsecs);
+    ++statistics.count;
+
+    // sections nested in a decoration paint are recorded first,
+    // so that reporting after the outer one covers complete frames
+    if ((section == Profiler::DecorationPaint || section == Profiler::DecorationInit) && statistics.count >= s.interval) {
+        Profiler::report();
+    }
+}
+
+void addTraceEvent(ProfilerState &s, Profiler::Section section, qint64 start, qint64 nsecs, quint64 windowId)
+{
+    // complete event, with microsecond timestamps
+    s.traceBuffer += "{\"name\":\"";
+    s.traceBuffer += sectionName(section);
+    s.traceBuffer += "\",\"cat\":\"inspire\",\"ph\":\"X\",\"ts\":";
+    s.traceBuffer += QByteArray::number(start / 1000.0, 'f', 3);
+    s.traceBuffer += ",\"dur\":";
+    s.traceBuffer += QByteArray::number(nsecs / 1000.0, 'f', 3);
+    s.traceBuffer += ",\"pid\":";
+    s.traceBuffer += QByteArray::number(qint64(getpid()));
+    s.traceBuffer += ",\"tid\":0,\"args\":{\"window\":\"0x";
+    s.traceBuffer += QByteArray::number(windowId, 16);
+    s.traceBuffer += "\"}},\n";
+
+    if (s.traceBuffer.size() >= 64 * 1024) {
+        s.flush();
+    }
+}
+
+} // namespace
+
+bool Profiler::isEnabled()
+{
+    const ProfilerState &s = state();
+    return s.profiling || s.tracing;
+}
+
+qint64 Profiler::timestamp()
+{
+    return state().timer.nsecsElapsed();
+}
+
+void Profiler::record(Section section, qint64 start, qint64 nsecs, quint64 windowId)
+{
+    ProfilerState &s = state();
+    if (s.tracing) {
+        addTraceEvent(s, section, start, nsecs, windowId);
+    }
+
+    if (s.profiling) {
+        addStatistics(s, section, nsecs);
+    }
+}
+
+void Profiler::report()
+{
+    ProfilerState &s = state();
+    if (!s.profiling) {
+        s.flush();
+        return;
+    }
+
+    for (int section = 0; section < SectionCount; ++section) {
+        Statistics &statistics = s.statistics[section];
+        if (statistics.count == 0) {
+            continue;
+        }
+
+        qDebug().nospace() << "Inspire profiler: " << sectionName(Section(section))
+                           << " samples=" << statistics.count
+                           << " avg=" << statistics.total / statistics.count << "ns"
+                           << " min=" << statistics.minimum << "ns"
+                           << " max=" << statistics.maximum << "ns"
+                           << " p50=" << percentile(statistics.samples, 50) << "ns"
+                           << " p90=" << percentile(statistics.samples, 90) << "ns"
+                           << " p99=" << percentile(statistics.samples, 99) << "ns";
+
+        statistics = Statistics();
+    }
+
+    qDebug().nospace() << "Inspire profiler: rss=" << residentMemory() << "kB";
+    s.flush();
+}
+
+qint64 Profiler::residentMemory()
+{
+    // second field of statm is the resident set size, in pages
+    QFile file(QStringLiteral("/proc/self/statm"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+
+    const QList<QByteArray> fields = file.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+
+    bool ok = false;
+    const qint64 pages = fields.at(1).toLongLong(&ok);
+    return ok ? pages * sysconf(_SC_PAGESIZE) / 1024 : -1;
+}
+
+} // namespace Inspire
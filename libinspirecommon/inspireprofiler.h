@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Inspire contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+// own
+#include "inspirecommon_export.h"
+
+// Qt
+#include <QtGlobal>
+
+namespace Inspire
+{
+
+/**
+ * In-process profiler for the decoration hot paths.
+ *
+ * Profiling is disabled unless the INSPIRE_PROFILE environment variable is set
+ * when kwin starts. Timings are then accumulated per section, and reported to
+ * the debug output, together with the resident memory of the process, every
+ * INSPIRE_PROFILE decoration paints or initializations (500 if the variable
+ * is not a positive number).
+ *
+ * Independently, setting INSPIRE_TRACE to a file path writes every section as
+ * a complete event in the Chrome trace event format, tagged with the window id,
+ * which can be loaded in chrome://tracing or Perfetto.
+ *
+ * Decorations are painted from the main thread, and so is profiling.
+ **/
+class INSPIRECOMMON_EXPORT Profiler
+{
+public:
+    enum Section {
+        DecorationPaint,
+        TitleBarPaint,
+        ButtonPaint,
+        DecorationInit,
+        DecorationReconfigure,
+        RecalculateBorders,
+        SettingsLookup,
+        ShadowCreate,
+        ShadowRender,
+        SectionCount,
+    };
+
+    /**
+     * Whether profiling or tracing is enabled.
+     **/
+    static bool isEnabled();
+
+    /**
+     * Monotonic time, in nanoseconds.
+     **/
+    static qint64 timestamp();
+
+    /**
+     * Add a sample to a section.
+     * @param section The profiled section.
+     * @param start The start time, as returned by timestamp().
+     * @param nsecs The elapsed time, in nanoseconds.
+     * @param windowId The window the sample relates to, if any.
+     **/
+    static void record(Section section, qint64 start, qint64 nsecs, quint64 windowId = 0);
+
+    /**
+     * Write accumulated statistics to the debug output, and reset them.
+     **/
+    static void report();
+
+    /**
+     * Resident set size of the process, in kilobytes, or -1 if unavailable.
+     **/
+    static qint64 residentMemory();
+
+    /**
+     * Times the enclosing scope, when profiling or tracing is enabled.
+     **/
+    class Scope
+    {
+    public:
+        explicit Scope(Section section, quint64 windowId = 0)
+            : m_section(section)
+            , m_windowId(windowId)
+            , m_start(Profiler::isEnabled() ? Profiler::timestamp() : -1)
+        {
+        }
+
+        ~Scope()
+        {
+            if (m_start >= 0) {
+                Profiler::record(m_section, m_start, Profiler::timestamp() - m_start, m_windowId);
+            }
+        }
+
+        Q_DISABLE_COPY(Scope)
+
+    private:
+        Section m_section;
+        quint64 m_windowId;
+        qint64 m_start;
+    };
+};
+
+} // namespace Inspire